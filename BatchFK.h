@@ -0,0 +1,196 @@
+#ifndef BATCH_FK_H
+#define BATCH_FK_H
+
+#include <cstddef>
+#include <cmath>
+#include <glm.hpp>
+
+#include "Kinematics.h"
+
+// Ширина SIMD выбирается при компиляции: /arch:AVX2 (__AVX2__) - 8 поз за инструкцию,
+// иначе SSE2 (есть на любом x64) - 4. BATCH_FK_SCALAR отключает векторизацию.
+#if !defined(BATCH_FK_SCALAR) && defined(__AVX2__)
+#define BATCH_FK_AVX2
+#include <immintrin.h>
+#elif !defined(BATCH_FK_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BATCH_FK_SSE2
+#include <emmintrin.h>
+#endif
+
+// Пакетная прямая кинематика: позы хранятся по полям (SoA) в регистрах, одна
+// инструкция считает сразу W конфигураций. Поворот сустава - кватернион от
+// половинного угла; sin/cos - полиномы, так что скалярный хвост и SIMD-путь
+// дают одинаковые результаты. Кватернион может отличаться знаком от toolPose:
+// q и -q - один и тот же поворот.
+namespace BatchFK {
+
+struct ScalarLanes {
+    static const int WIDTH = 1;
+    float v;
+    ScalarLanes() {}
+    ScalarLanes(float v) : v(v) {}
+    static ScalarLanes load(const float* p) { return ScalarLanes(*p); }
+    void store(float* p) const { *p = v; }
+    friend ScalarLanes operator+(ScalarLanes a, ScalarLanes b) { return a.v + b.v; }
+    friend ScalarLanes operator-(ScalarLanes a, ScalarLanes b) { return a.v - b.v; }
+    friend ScalarLanes operator*(ScalarLanes a, ScalarLanes b) { return a.v * b.v; }
+    // Округление к ближайшему целому (|x| < 2^31)
+    friend ScalarLanes roundNearest(ScalarLanes a) { return std::nearbyint(a.v); }
+};
+
+#if defined(BATCH_FK_SSE2) || defined(BATCH_FK_AVX2)
+struct Sse2Lanes {
+    static const int WIDTH = 4;
+    __m128 v;
+    Sse2Lanes() {}
+    Sse2Lanes(__m128 v) : v(v) {}
+    Sse2Lanes(float s) : v(_mm_set1_ps(s)) {}
+    static Sse2Lanes load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend Sse2Lanes operator+(Sse2Lanes a, Sse2Lanes b) { return _mm_add_ps(a.v, b.v); }
+    friend Sse2Lanes operator-(Sse2Lanes a, Sse2Lanes b) { return _mm_sub_ps(a.v, b.v); }
+    friend Sse2Lanes operator*(Sse2Lanes a, Sse2Lanes b) { return _mm_mul_ps(a.v, b.v); }
+    friend Sse2Lanes roundNearest(Sse2Lanes a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)); }
+};
+#endif
+
+#if defined(BATCH_FK_AVX2)
+struct Avx2Lanes {
+    static const int WIDTH = 8;
+    __m256 v;
+    Avx2Lanes() {}
+    Avx2Lanes(__m256 v) : v(v) {}
+    Avx2Lanes(float s) : v(_mm256_set1_ps(s)) {}
+    static Avx2Lanes load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    friend Avx2Lanes operator+(Avx2Lanes a, Avx2Lanes b) { return _mm256_add_ps(a.v, b.v); }
+    friend Avx2Lanes operator-(Avx2Lanes a, Avx2Lanes b) { return _mm256_sub_ps(a.v, b.v); }
+    friend Avx2Lanes operator*(Avx2Lanes a, Avx2Lanes b) { return _mm256_mul_ps(a.v, b.v); }
+    friend Avx2Lanes roundNearest(Avx2Lanes a) { return _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+};
+typedef Avx2Lanes WideLanes;
+#elif defined(BATCH_FK_SSE2)
+typedef Sse2Lanes WideLanes;
+#else
+typedef ScalarLanes WideLanes;
+#endif
+
+inline const char* isaName() {
+#if defined(BATCH_FK_AVX2)
+    return "AVX2";
+#elif defined(BATCH_FK_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+template <typename F>
+struct Quat { F w, x, y, z; };
+
+template <typename F>
+struct Vec3 { F x, y, z; };
+
+template <typename F>
+inline Quat<F> mul(const Quat<F>& a, const Quat<F>& b) {
+    Quat<F> r;
+    r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    r.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    r.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    r.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    return r;
+}
+
+// v' = v + 2w(u x v) + 2u x (u x v), u = (x, y, z)
+template <typename F>
+inline Vec3<F> rotate(const Quat<F>& q, const Vec3<F>& v) {
+    F tx = F(2.0f) * (q.y * v.z - q.z * v.y);
+    F ty = F(2.0f) * (q.z * v.x - q.x * v.z);
+    F tz = F(2.0f) * (q.x * v.y - q.y * v.x);
+    Vec3<F> r;
+    r.x = v.x + q.w * tx + (q.y * tz - q.z * ty);
+    r.y = v.y + q.w * ty + (q.z * tx - q.x * tz);
+    r.z = v.z + q.w * tz + (q.x * ty - q.y * tx);
+    return r;
+}
+
+// Синус и косинус половинного угла сустава. Угол в градусах сначала сводится
+// к [-180, 180], половина - к [-pi/2, pi/2], где ряды Тейлора до x^11 / x^12
+// точнее 1e-7.
+template <typename F>
+inline void halfAngleSinCos(F degrees, F& s, F& c) {
+    F wrapped = degrees - roundNearest(degrees * F(1.0f / 360.0f)) * F(360.0f);
+    F x = wrapped * F(3.14159265358979f / 360.0f);
+    F x2 = x * x;
+    s = x * (F(1.0f) + x2 * (F(-1.0f / 6.0f) + x2 * (F(1.0f / 120.0f) + x2 * (F(-1.0f / 5040.0f) +
+        x2 * (F(1.0f / 362880.0f) + x2 * F(-1.0f / 39916800.0f))))));
+    c = F(1.0f) + x2 * (F(-0.5f) + x2 * (F(1.0f / 24.0f) + x2 * (F(-1.0f / 720.0f) +
+        x2 * (F(1.0f / 40320.0f) + x2 * (F(-1.0f / 3628800.0f) + x2 * F(1.0f / 479001600.0f))))));
+}
+
+// W = F::WIDTH поз, начиная с states/poses
+template <typename F>
+inline void evaluateLanes(const KinematicTree& tree, const JointState* states, Pose* poses) {
+    const int W = F::WIDTH;
+    const size_t jointCount = tree.jointCount();
+    Quat<F> rotation[MAX_JOINTS];
+    Vec3<F> translation[MAX_JOINTS];
+    float lane[8];
+
+    for (size_t j = 0; j < jointCount; j++) {
+        const Joint& joint = tree.joints[j];
+        for (int l = 0; l < W; l++)
+            lane[l] = states[l].angles[j];
+
+        F s, c;
+        halfAngleSinCos(F::load(lane), s, c);
+        Quat<F> local = { c, s * F(joint.axis.x), s * F(joint.axis.y), s * F(joint.axis.z) };
+        // Поворот вокруг опоры p: t = p - q p
+        Vec3<F> pivot = { F(joint.pivot.x), F(joint.pivot.y), F(joint.pivot.z) };
+        Vec3<F> moved = rotate(local, pivot);
+        Vec3<F> localT = { pivot.x - moved.x, pivot.y - moved.y, pivot.z - moved.z };
+
+        if (joint.parent < 0) {
+            rotation[j] = local;
+            translation[j] = localT;
+        }
+        else {
+            const Quat<F>& pq = rotation[joint.parent];
+            const Vec3<F>& pt = translation[joint.parent];
+            rotation[j] = mul(pq, local);
+            Vec3<F> r = rotate(pq, localT);
+            translation[j] = { r.x + pt.x, r.y + pt.y, r.z + pt.z };
+        }
+    }
+
+    Quat<F> q = { F(1.0f), F(0.0f), F(0.0f), F(0.0f) };
+    Vec3<F> p = { F(tree.toolPoint.x), F(tree.toolPoint.y), F(tree.toolPoint.z) };
+    if (tree.toolJoint >= 0) {
+        q = rotation[tree.toolJoint];
+        Vec3<F> r = rotate(q, p);
+        const Vec3<F>& t = translation[tree.toolJoint];
+        p = { r.x + t.x, r.y + t.y, r.z + t.z };
+    }
+
+    float out[7][8];
+    q.w.store(out[0]); q.x.store(out[1]); q.y.store(out[2]); q.z.store(out[3]);
+    p.x.store(out[4]); p.y.store(out[5]); p.z.store(out[6]);
+    for (int l = 0; l < W; l++) {
+        poses[l].rotation = glm::quat(out[0][l], out[1][l], out[2][l], out[3][l]);
+        poses[l].position = glm::vec3(out[4][l], out[5][l], out[6][l]);
+    }
+}
+
+} // namespace BatchFK
+
+// Рабочая точка для count конфигураций: полными SIMD-пачками, хвост - скалярно
+inline void evaluateFK(const KinematicTree& tree, const JointState* states, size_t count, Pose* poses) {
+    const size_t W = BatchFK::WideLanes::WIDTH;
+    size_t i = 0;
+    for (; i + W <= count; i += W)
+        BatchFK::evaluateLanes<BatchFK::WideLanes>(tree, states + i, poses + i);
+    for (; i < count; i++)
+        BatchFK::evaluateLanes<BatchFK::ScalarLanes>(tree, states + i, poses + i);
+}
+
+#endif // BATCH_FK_H
@@ -0,0 +1,601 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <glm.hpp>
+#include <matrix_transform.hpp>
+
+#include "Shader.h"
+#include "Model.h"
+#include "UniformBuffer.h"
+#include "Kinematics.h"
+#include "InstancedRenderer.h"
+#include "BatchFK.h"
+#include "WorkspaceSampler.h"
+#include "InverseKinematics.h"
+#include "JointChannel.h"
+#include "IndirectRenderer.h"
+#include "GLCalls.h"
+#include "RenderQueue.h"
+#include <GLFW/glfw3.h>
+
+// Стоимость вершинной стадии: inverse() на каждую вершину против готовой матрицы нормалей.
+// GL_RASTERIZER_DISCARD отключает растеризацию, так что фрагментный шейдер не влияет на замер.
+// Аргументы: [уровни подразделения = 2] [проходов = 200]
+inline int benchNormalMatrix(int argc, char** argv) {
+    unsigned int levels = argc > 0 ? (unsigned int)atoi(argv[0]) : 2;
+    int passes = argc > 1 ? atoi(argv[1]) : 200;
+
+    Model model("manipulator.obj", levels);
+    size_t indexCount = 0;
+    for (size_t i = 0; i < model.meshes.size(); i++) {
+        indexCount += model.meshes[i].indexCount;
+        model.meshTransforms[i] = glm::rotate(glm::mat4(1.0f), 0.3f * i, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    UniformBuffer<CameraBlock> cameraUbo(CAMERA_BLOCK_BINDING);
+    CameraBlock camera = {};
+    camera.projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    camera.view = glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    cameraUbo.update(camera);
+
+    Shader legacy("bench_vertex_inverse.glsl", "fragment_shader.glsl");
+    Shader current("vertex_sheder.glsl", "fragment_shader.glsl");
+
+    unsigned int query;
+    glGenQueries(1, &query);
+    GLCalls::setCapability(GL_RASTERIZER_DISCARD, true);
+
+    auto measure = [&](Shader& shader, bool precomputed) {
+        shader.use();
+        UniformHandle<glm::mat4> uModel = shader.uniform<glm::mat4>("model");
+        UniformHandle<glm::mat3> uNormal;
+        if (precomputed)
+            uNormal = shader.uniform<glm::mat3>("normalMatrix");
+
+        model.Draw(shader, uModel, uNormal); // прогрев
+        glFinish();
+
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        for (int p = 0; p < passes; p++)
+            model.Draw(shader, uModel, uNormal);
+        glEndQuery(GL_TIME_ELAPSED);
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        return (double)ns;
+    };
+
+    double legacyNs = measure(legacy, false);
+    double currentNs = measure(current, true);
+
+    GLCalls::setCapability(GL_RASTERIZER_DISCARD, false);
+    glDeleteQueries(1, &query);
+
+    double invocations = (double)indexCount * passes;
+    std::cout << "normal matrix benchmark: " << model.meshes.size() << " meshes, "
+        << indexCount << " indices, subdivision " << levels << ", " << passes << " passes\n"
+        << "  inverse() per vertex : " << legacyNs / 1e6 << " ms (" << legacyNs / invocations << " ns/vertex)\n"
+        << "  precomputed on CPU   : " << currentNs / 1e6 << " ms (" << currentNs / invocations << " ns/vertex)\n"
+        << "  speedup              : " << legacyNs / currentNs << "x" << std::endl;
+    return 0;
+}
+
+// Сколько ОЗУ занимает геометрия модели при каждой политике хранения CPU-копии
+inline int benchMemory(int argc, char** argv) {
+    const char* path = argc > 0 ? argv[0] : "manipulator.obj";
+    const CpuGeometryPolicy policies[] = {
+        CpuGeometryPolicy::KeepCpuCopy, CpuGeometryPolicy::KeepCompressed, CpuGeometryPolicy::DropAfterUpload
+    };
+    const char* names[] = { "KeepCpuCopy", "KeepCompressed", "DropAfterUpload" };
+
+    size_t baseline = 0;
+    std::cout << "CPU geometry memory for " << path << ":\n";
+    for (int i = 0; i < 3; i++) {
+        uint64_t rssBefore = residentBytes();
+        Model model(path, 0, policies[i]);
+        uint64_t rssAfter = residentBytes();
+        size_t bytes = model.cpuGeometryBytes();
+        if (i == 0)
+            baseline = bytes;
+        std::cout << "  " << names[i] << ": " << bytes / 1024.0 << " KB geometry";
+        if (baseline > 0)
+            std::cout << " (saves " << 100.0 * (1.0 - (double)bytes / baseline) << "%)";
+        std::cout << ", RSS delta " << ((double)rssAfter - (double)rssBefore) / 1024.0 << " KB"
+            << (model.loadStats.fromCache ? " [cache]" : " [assimp]") << "\n";
+    }
+    std::cout << std::flush;
+    return 0;
+}
+
+// Анимированный парк манипуляторов: прежний цикл (uniform-ы и вызов на каждую часть
+// каждого манипулятора) против инстансинга. Время кадра до glFinish, т.е. CPU + GPU.
+// Аргументы: [манипуляторов = 10000] [кадров = 60]
+inline int benchFleet(int argc, char** argv) {
+    int armCount = argc > 0 ? atoi(argv[0]) : 10000;
+    int frames = argc > 1 ? atoi(argv[1]) : 60;
+
+    Model model("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    KinematicTree kinematics("manipulator.kin");
+    kinematics.bind(model);
+
+    UniformBuffer<CameraBlock> cameraUbo(CAMERA_BLOCK_BINDING);
+    CameraBlock camera = {};
+    camera.projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    camera.view = glm::lookAt(glm::vec3(0.0f, 40.0f, 40.0f), glm::vec3(100.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    cameraUbo.update(camera);
+
+    std::vector<glm::mat4> armTransforms(armCount);
+    std::vector<JointState> states(armCount);
+    const int gridSide = (int)std::ceil(std::sqrt((float)armCount));
+    for (int i = 0; i < armCount; i++) {
+        armTransforms[i] = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f * (i % gridSide), 0.0f, -2.0f * (i / gridSide)));
+    }
+    auto animate = [&](int frame) {
+        for (int i = 0; i < armCount; i++)
+            states[i] = kinematics.sweepPose(frame / 60.0f + 0.37f * i);
+    };
+
+    GLCalls::setCapability(GL_DEPTH_TEST, true);
+    Shader perPart("vertex_sheder.glsl", "fragment_shader.glsl");
+    Shader instanced("vertex_instanced.glsl", "fragment_shader.glsl");
+    InstancedRenderer fleet;
+
+    // Вызовы GL последнего кадра каждого варианта
+    GLCallStats calls;
+    auto run = [&](bool useInstancing) {
+        Shader& shader = useInstancing ? instanced : perPart;
+        UniformHandle<glm::mat4> uModel;
+        UniformHandle<glm::mat3> uNormal;
+        if (!useInstancing) {
+            uModel = shader.uniform<glm::mat4>("model");
+            uNormal = shader.uniform<glm::mat3>("normalMatrix");
+        }
+        std::vector<glm::mat4> parts(model.meshes.size());
+        glFinish();
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            GLCalls::stats() = GLCallStats();
+            animate(f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            shader.use();
+            if (useInstancing) {
+                fleet.Draw(model, kinematics, armTransforms.data(), states.data(), armCount);
+            }
+            else {
+                for (int i = 0; i < armCount; i++) {
+                    kinematics.computePartTransforms(states[i], parts.data(), parts.size());
+                    for (size_t p = 0; p < parts.size(); p++)
+                        model.meshTransforms[p] = armTransforms[i] * parts[p];
+                    model.Draw(shader, uModel, uNormal);
+                }
+            }
+            glFinish();
+            calls = GLCalls::stats();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+    };
+
+    double loopMs = run(false);
+    GLCallStats loopCalls = calls;
+    double instancedMs = run(true);
+    GLCallStats instancedCalls = calls;
+
+    std::cout << "fleet benchmark: " << armCount << " animated arms, " << frames << " frames\n"
+        << "  per-part loop : " << loopMs << " ms/frame (" << 1000.0 / loopMs << " FPS)\n"
+        << "                  " << loopCalls << "\n"
+        << "  instanced     : " << instancedMs << " ms/frame (" << 1000.0 / instancedMs << " FPS)\n"
+        << "                  " << instancedCalls << "\n"
+        << "  speedup       : " << loopMs / instancedMs << "x" << std::endl;
+    return 0;
+}
+
+// Очередь рисования: манипуляторы по частям, чётные и нечётные - разными программами
+// (готовая матрица нормалей и inverse() в шейдере), в порядке отправки против порядка
+// после сортировки RenderQueue. Отдельно - сортировка ключей кадра поразрядно и std::sort.
+// Аргументы: [манипуляторов = 2000] [кадров = 60]
+inline int benchRenderQueue(int argc, char** argv) {
+    int armCount = argc > 0 ? atoi(argv[0]) : 2000;
+    int frames = argc > 1 ? atoi(argv[1]) : 60;
+    const float farPlane = 1000.0f;
+
+    Model model("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    KinematicTree kinematics("manipulator.kin");
+    kinematics.bind(model);
+
+    UniformBuffer<CameraBlock> cameraUbo(CAMERA_BLOCK_BINDING);
+    CameraBlock camera = {};
+    camera.projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, farPlane);
+    camera.view = glm::lookAt(glm::vec3(0.0f, 40.0f, 40.0f), glm::vec3(100.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    cameraUbo.update(camera);
+
+    std::vector<glm::mat4> armTransforms(armCount);
+    std::vector<JointState> states(armCount);
+    const int gridSide = (int)std::ceil(std::sqrt((float)armCount));
+    for (int i = 0; i < armCount; i++) {
+        armTransforms[i] = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f * (i % gridSide), 0.0f, -2.0f * (i / gridSide)));
+        states[i] = kinematics.sweepPose(0.37f * i);
+    }
+
+    GLCalls::setCapability(GL_DEPTH_TEST, true);
+    Shader normals("vertex_sheder.glsl", "fragment_shader.glsl");
+    Shader inverse("bench_vertex_inverse.glsl", "fragment_shader.glsl");
+    Shader* programs[2] = { &normals, &inverse };
+    UniformHandle<glm::mat4> uModel[2] = { normals.uniform<glm::mat4>("model"), inverse.uniform<glm::mat4>("model") };
+    UniformHandle<glm::mat3> uNormal[2] = { normals.uniform<glm::mat3>("normalMatrix"), UniformHandle<glm::mat3>() };
+
+    RenderQueue queue;
+    std::vector<glm::mat4> parts(model.meshes.size());
+    auto submitFrame = [&]() {
+        for (int i = 0; i < armCount; i++) {
+            kinematics.computePartTransforms(states[i], parts.data(), parts.size());
+            for (size_t p = 0; p < parts.size(); p++)
+                model.meshTransforms[p] = parts[p];
+            queue.submitModel(model, *programs[i % 2], uModel[i % 2], uNormal[i % 2], armTransforms[i],
+                camera.view, farPlane);
+        }
+    };
+
+    // Вызовы GL последнего кадра каждого варианта
+    GLCallStats calls;
+    auto run = [&](bool sorted) {
+        glFinish();
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            GLCalls::stats() = GLCallStats();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            submitFrame();
+            if (sorted)
+                queue.flush();
+            else
+                queue.flushUnsorted();
+            glFinish();
+            calls = GLCalls::stats();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+    };
+
+    double submittedMs = run(false);
+    GLCallStats submittedCalls = calls;
+    double sortedMs = run(true);
+    GLCallStats sortedCalls = calls;
+
+    // Только сортировка ключей одного кадра, оба варианта - из порядка отправки
+    submitFrame();
+    std::vector<uint64_t> submittedKeys;
+    for (const DrawItem& item : queue.submitted())
+        submittedKeys.push_back(item.key);
+    const int sortRuns = 100;
+    auto radixStart = std::chrono::steady_clock::now();
+    for (int r = 0; r < sortRuns; r++)
+        queue.sort();
+    double radixUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - radixStart).count() / sortRuns;
+    double stdUs = 0.0;
+    std::vector<uint64_t> keys;
+    for (int r = 0; r < sortRuns; r++) {
+        keys = submittedKeys;
+        auto stdStart = std::chrono::steady_clock::now();
+        std::sort(keys.begin(), keys.end());
+        stdUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stdStart).count();
+    }
+    stdUs /= sortRuns;
+    const size_t items = queue.size();
+    queue.clear();
+
+    std::cout << "render queue benchmark: " << armCount << " arms, " << items << " draw items, 2 programs, "
+        << frames << " frames\n"
+        << "  submission order: " << submittedMs << " ms/frame\n"
+        << "                    " << submittedCalls << "\n"
+        << "  sorted queue    : " << sortedMs << " ms/frame\n"
+        << "                    " << sortedCalls << "\n"
+        << "  key sort        : radix " << radixUs << " us, std::sort " << stdUs << " us" << std::endl;
+    return 0;
+}
+
+// Стоимость одного сустава прямой кинематики: прежняя цепочка полных mat4
+// (rotAroundPoint) против RigidTransform с переводом в mat4 для заливки.
+// Цепочка синтетическая, GL не используется.
+// Аргументы: [суставов = 6] [поз = 1000000]
+inline int benchForwardKinematics(int argc, char** argv) {
+    int jointCount = argc > 0 ? atoi(argv[0]) : 6;
+    int poses = argc > 1 ? atoi(argv[1]) : 1000000;
+    jointCount = std::max(1, std::min(jointCount, MAX_JOINTS));
+
+    KinematicTree tree;
+    for (int j = 0; j < jointCount; j++) {
+        Joint joint;
+        joint.name = "j" + std::to_string(j);
+        joint.parent = j - 1;
+        joint.axis = glm::normalize(glm::vec3(j % 2, 1.0f - j % 2, 0.25f * j));
+        joint.pivot = glm::vec3(0.1f * j, 0.3f * j, -0.05f * j);
+        tree.joints.push_back(joint);
+    }
+    // Набор поз заранее, чтобы углы не были константами для компилятора
+    const int stateCount = 256;
+    std::vector<JointState> states(stateCount);
+    for (int i = 0; i < stateCount; i++)
+        states[i] = tree.sweepPose(0.1f * i);
+
+    glm::mat4 world[MAX_JOINTS];
+    float checksum = 0.0f;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < poses; i++) {
+        const JointState& state = states[i % stateCount];
+        for (int j = 0; j < jointCount; j++) {
+            const Joint& joint = tree.joints[j];
+            glm::mat4 local = rotAroundPoint(glm::radians(state.angles[j]), joint.pivot, joint.axis);
+            world[j] = joint.parent < 0 ? local : world[joint.parent] * local;
+        }
+        checksum += world[jointCount - 1][3][0];
+    }
+    double matrixNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    glm::mat4 matrixLast = world[jointCount - 1];
+
+    RigidTransform rigid[MAX_JOINTS];
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < poses; i++) {
+        const JointState& state = states[i % stateCount];
+        tree.evaluate(state, rigid);
+        for (int j = 0; j < jointCount; j++)
+            world[j] = rigid[j].toMat4();
+        checksum += world[jointCount - 1][3][0];
+    }
+    double rigidNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Последняя поза обоими способами должна совпасть
+    float maxError = 0.0f;
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            maxError = std::max(maxError, std::abs(matrixLast[c][r] - world[jointCount - 1][c][r]));
+
+    const double joints = (double)poses * jointCount;
+    std::cout << "forward kinematics: " << jointCount << " joints, " << poses << " poses\n"
+        << "  mat4 chain     : " << matrixNs / joints << " ns/joint\n"
+        << "  RigidTransform : " << rigidNs / joints << " ns/joint (incl. toMat4)\n"
+        << "  speedup        : " << matrixNs / rigidNs << "x\n"
+        << "  max |diff|     : " << maxError << " (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
+
+// Пакетная прямая кинематика manipulator.kin на одном ядре: конфигураций в секунду
+// для toolPose по одной, того же ядра evaluateFK в скалярном виде и в SIMD.
+// Аргументы: [конфигураций = 4000000]
+inline int benchBatchFK(int argc, char** argv) {
+    size_t count = argc > 0 ? (size_t)atoll(argv[0]) : 4000000;
+
+    Model model("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    KinematicTree tree("manipulator.kin");
+    tree.bind(model);
+
+    // Равномерно по пределам суставов, детерминированно
+    std::vector<JointState> states(count);
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < tree.jointCount(); j++) {
+            seed = seed * 1664525u + 1013904223u;
+            float t = (seed >> 8) * (1.0f / 16777216.0f);
+            states[i].angles[j] = tree.joints[j].minAngle + t * (tree.joints[j].maxAngle - tree.joints[j].minAngle);
+        }
+    }
+    std::vector<Pose> reference(count), scalar(count), batched(count);
+
+    auto rate = [count](std::chrono::steady_clock::time_point start) {
+        return count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+        reference[i] = tree.toolPose(states[i]);
+    double referenceRate = rate(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+        BatchFK::evaluateLanes<BatchFK::ScalarLanes>(tree, &states[i], &scalar[i]);
+    double scalarRate = rate(start);
+
+    start = std::chrono::steady_clock::now();
+    evaluateFK(tree, states.data(), count, batched.data());
+    double batchedRate = rate(start);
+
+    float maxPosition = 0.0f, maxRotation = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        maxPosition = std::max(maxPosition, glm::length(batched[i].position - reference[i].position));
+        maxRotation = std::max(maxRotation, 1.0f - std::abs(glm::dot(batched[i].rotation, reference[i].rotation)));
+    }
+
+    std::cout << "batch forward kinematics: " << tree.jointCount() << " joints, " << count << " configurations, 1 thread\n"
+        << "  toolPose (glm)   : " << referenceRate / 1e6 << " M configs/s\n"
+        << "  evaluateFK scalar: " << scalarRate / 1e6 << " M configs/s\n"
+        << "  evaluateFK " << BatchFK::isaName() << " x" << BatchFK::WideLanes::WIDTH << ": " << batchedRate / 1e6 << " M configs/s\n"
+        << "  max position diff: " << maxPosition << ", max 1-|dot(q)|: " << maxRotation << std::endl;
+    return 0;
+}
+
+// Масштабирование развёртки рабочей зоны по числу потоков: 1, 2, 4 ... ядер.
+// Аргументы: [выборок = 100000000] [ячейка = 0.025]
+inline int benchWorkspace(int argc, char** argv) {
+    uint64_t samples = argc > 0 ? (uint64_t)atoll(argv[0]) : 100000000ull;
+    float voxel = argc > 1 ? (float)atof(argv[1]) : 0.025f;
+
+    Model model("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    KinematicTree tree("manipulator.kin");
+    tree.bind(model);
+
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "workspace sweep: " << samples << " samples, voxel " << voxel << ", " << cores << " cores\n";
+    double single = 0.0;
+    for (unsigned int threads = 1;; threads = std::min(cores, threads * 2)) {
+        WorkspaceMap map = sampleWorkspace(tree, samples, voxel, threads);
+        double rate = map.samples / map.seconds;
+        if (threads == 1)
+            single = rate;
+        std::cout << "  " << threads << " threads: " << map.seconds << " s, " << rate / 1e6 << " M samples/s, efficiency "
+            << 100.0 * rate / (single * threads) << "%, " << map.centers.size() << " voxels" << std::endl;
+        if (threads == cores)
+            break;
+    }
+    return 0;
+}
+
+// Время решения IK по случайным достижимым целям (рабочая точка случайной позы в пределах):
+// "с нуля" - из нулевой позы, "слежение" - цель движется по гладкой траектории
+// с шагом 1 мс, начальное приближение - прошлое решение (как в цикле управления 1 кГц).
+// Аргументы: [целей = 10000]
+inline int benchInverseKinematics(int argc, char** argv) {
+    int targets = argc > 0 ? atoi(argv[0]) : 10000;
+    targets = std::max(targets, 1);
+
+    Model model("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    KinematicTree tree("manipulator.kin");
+    tree.bind(model);
+
+    auto report = [](const char* name, std::vector<double>& micros, int converged, double iterations) {
+        std::sort(micros.begin(), micros.end());
+        auto pct = [&micros](double p) { return micros[std::min(micros.size() - 1, (size_t)(p * micros.size()))]; };
+        std::cout << "  " << name << ": p50 " << pct(0.5) << " us, p90 " << pct(0.9) << " us, p99 " << pct(0.99)
+            << " us, max " << micros.back() << " us, converged " << converged << "/" << micros.size()
+            << ", iterations " << iterations / micros.size() << std::endl;
+    };
+
+    std::cout << "inverse kinematics: " << tree.jointCount() << " joints, " << targets << " targets\n";
+
+    std::vector<double> micros;
+    int converged = 0;
+    double iterations = 0.0;
+    unsigned int seed = 12345;
+    for (int i = 0; i < targets; i++) {
+        JointState goal;
+        for (size_t j = 0; j < tree.jointCount(); j++) {
+            seed = seed * 1664525u + 1013904223u;
+            float t = (seed >> 8) * (1.0f / 16777216.0f);
+            goal.angles[j] = tree.joints[j].minAngle + t * (tree.joints[j].maxAngle - tree.joints[j].minAngle);
+        }
+        glm::vec3 target = tree.toolPose(goal).position;
+        JointState state;
+        tree.clamp(state);
+        auto start = std::chrono::steady_clock::now();
+        IKResult result = solveIK(tree, target, state);
+        micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        converged += result.converged;
+        iterations += result.iterations;
+    }
+    report("from zero pose", micros, converged, iterations);
+
+    micros.clear();
+    converged = 0;
+    iterations = 0.0;
+    JointState state = tree.sweepPose(0.0f);
+    for (int i = 0; i < targets; i++) {
+        glm::vec3 target = tree.toolPose(tree.sweepPose(0.001f * i)).position;
+        auto start = std::chrono::steady_clock::now();
+        IKResult result = solveIK(tree, target, state);
+        micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        converged += result.converged;
+        iterations += result.iterations;
+    }
+    report("tracking 1 kHz ", micros, converged, iterations);
+    return 0;
+}
+
+// Задержка от метки времени производителя до показанного кадра. Производитель -
+// поток этого же процесса, но пишет через тот же именованный канал в разделяемой
+// памяти, что и Lab_7 --produce. Кадр считается показанным после SwapBuffers + glFinish.
+// Аргументы: [секунд = 5] [Гц производителя = 1000]
+inline int benchControllerLatency(int argc, char** argv) {
+    double seconds = argc > 0 ? atof(argv[0]) : 5.0;
+    double rate = argc > 1 ? atof(argv[1]) : 1000.0;
+
+    Model model("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    KinematicTree tree("manipulator.kin");
+    tree.bind(model);
+
+    const std::string name = std::string(JOINT_CHANNEL_NAME) + "_bench";
+    JointChannel producerSide(name, true);
+    JointChannel consumerSide(name, false);
+    if (!producerSide.valid() || !consumerSide.valid()) {
+        std::cerr << "ERROR::CHANNEL::CREATE_FAILED: " << name << std::endl;
+        return -1;
+    }
+    std::atomic<bool> running(true);
+    std::thread producer([&]() { runJointProducer(producerSide, tree, rate, 0.0, running); });
+
+    UniformBuffer<CameraBlock> cameraUbo(CAMERA_BLOCK_BINDING);
+    CameraBlock camera = {};
+    camera.projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    camera.view = glm::lookAt(glm::vec3(0.0f, 1.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    cameraUbo.update(camera);
+    Shader shader("vertex_indirect.glsl", "fragment_shader.glsl");
+    IndirectRenderer renderer;
+    glm::mat4 placement(1.0f);
+    GLCalls::setCapability(GL_DEPTH_TEST, true);
+
+    GLFWwindow* window = glfwGetCurrentContext();
+    std::vector<double> latencies;
+    JointState state;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds) {
+        JointSample sample;
+        int64_t sampleNs = 0;
+        if (consumerSide.poll(sample)) {
+            std::memcpy(state.angles, sample.angles, sizeof(state.angles));
+            sampleNs = sample.timestampNs;
+        }
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shader.use();
+        tree.computePartTransforms(state, model.meshTransforms.data(), model.meshTransforms.size());
+        renderer.Draw(model, &placement, 1);
+        glfwSwapBuffers(window);
+        glFinish();
+        if (sampleNs != 0)
+            latencies.push_back((channelClockNs() - sampleNs) * 1e-3);
+    }
+    running = false;
+    producer.join();
+
+    if (latencies.empty()) {
+        std::cerr << "WARNING::BENCH::NO_SAMPLES" << std::endl;
+        return -1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&latencies](double p) { return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))]; };
+    std::cout << "controller latency (producer timestamp -> frame presented), " << rate << " Hz producer, "
+        << latencies.size() << " frames\n"
+        << "  p50 " << pct(0.5) << " us, p90 " << pct(0.9) << " us, p99 " << pct(0.99) << " us, max " << latencies.back() << " us\n"
+        << "  samples skipped between frames: " << consumerSide.skippedSamples() << std::endl;
+    return 0;
+}
+
+// Режимы бенчмарков: Lab_7 --bench-<имя> [аргументы]
+inline int runBenchmark(const char* mode, int argc, char** argv) {
+    if (strcmp(mode, "--bench-normals") == 0)
+        return benchNormalMatrix(argc, argv);
+    if (strcmp(mode, "--bench-memory") == 0)
+        return benchMemory(argc, argv);
+    if (strcmp(mode, "--bench-fleet") == 0)
+        return benchFleet(argc, argv);
+    if (strcmp(mode, "--bench-queue") == 0)
+        return benchRenderQueue(argc, argv);
+    if (strcmp(mode, "--bench-fk") == 0)
+        return benchForwardKinematics(argc, argv);
+    if (strcmp(mode, "--bench-batch-fk") == 0)
+        return benchBatchFK(argc, argv);
+    if (strcmp(mode, "--bench-workspace") == 0)
+        return benchWorkspace(argc, argv);
+    if (strcmp(mode, "--bench-ik") == 0)
+        return benchInverseKinematics(argc, argv);
+    if (strcmp(mode, "--bench-latency") == 0)
+        return benchControllerLatency(argc, argv);
+
+    std::cerr << "Unknown benchmark: " << mode << std::endl;
+    return -1;
+}
+
+#endif // BENCH_H
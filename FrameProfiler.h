@@ -0,0 +1,431 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <glm.hpp>
+#include <GL/glew.h>
+
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "Trace.h"
+
+// min / среднее / p99 по последним WINDOW значениям
+class RollingStats {
+public:
+    static const size_t WINDOW = 240;
+
+    void add(double value) {
+        values[next] = value;
+        next = (next + 1) % WINDOW;
+        count = std::min(count + 1, size_t(WINDOW));
+    }
+
+    size_t size() const { return count; }
+
+    void compute(double& minimum, double& average, double& p99) const {
+        minimum = average = p99 = 0.0;
+        if (count == 0)
+            return;
+        sorted.assign(values, values + count);
+        size_t k = (count * 99) / 100;
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        p99 = sorted[k];
+        minimum = *std::min_element(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double v : sorted)
+            sum += v;
+        average = sum / count;
+    }
+
+private:
+    double values[WINDOW] = {};
+    size_t next = 0;
+    size_t count = 0;
+    mutable std::vector<double> sorted;
+};
+
+// Профилировщик кадра: для каждой именованной области - время CPU (steady_clock)
+// и время GPU по паре запросов GL_TIMESTAMP. Результаты запросов забираются через
+// LATENCY кадров и только если уже готовы (GL_QUERY_RESULT_AVAILABLE), так что
+// профилировщик никогда не ждёт GPU; не успевшие запросы считаются в lateQueries.
+// Области могут вкладываться, каждая меряется независимо. Область 0 - кадр целиком.
+// С LAB7_TRACE области попадают и в трассировку (Trace.h): CPU - на дорожку потока,
+// GPU - на дорожку "GPU", часы GPU сведены с CPU по GL_TIMESTAMP при создании.
+// Счётчики (counter/count) - произвольные числа за кадр (например, GLCalls::stats()),
+// идут в ту же таблицу и CSV рядом со временами своего кадра.
+class FrameProfiler {
+public:
+    static const int MAX_SCOPES = 16;
+    static const int MAX_COUNTERS = 16;
+    static const int LATENCY = 4;
+
+    FrameProfiler() {
+        glCreateQueries(GL_TIMESTAMP, LATENCY * MAX_SCOPES * 2, &queries[0][0][0]);
+        scope("frame");
+#ifdef LAB7_TRACE
+        gpuTrack = &Trace::track("GPU");
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuOffsetNs = Trace::nowNs() - gpuNow;
+#endif
+    }
+
+    ~FrameProfiler() {
+        glDeleteQueries(LATENCY * MAX_SCOPES * 2, &queries[0][0][0]);
+    }
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Регистрация области (до первого кадра); повторное имя - тот же индекс
+    int scope(const std::string& name) {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name)
+                return (int)i;
+        }
+        if (names.size() == MAX_SCOPES) {
+            std::cerr << "WARNING::PROFILER::TOO_MANY_SCOPES: " << name << std::endl;
+            return MAX_SCOPES - 1;
+        }
+#ifdef LAB7_TRACE
+        traceNames[names.size()] = Trace::intern(name);
+#endif
+        names.push_back(name);
+        cpu.emplace_back();
+        gpu.emplace_back();
+        return (int)names.size() - 1;
+    }
+
+    // Регистрация счётчика (до первого кадра)
+    int counter(const std::string& name) {
+        for (size_t i = 0; i < counterNames.size(); i++) {
+            if (counterNames[i] == name)
+                return (int)i;
+        }
+        if (counterNames.size() == MAX_COUNTERS) {
+            std::cerr << "WARNING::PROFILER::TOO_MANY_COUNTERS: " << name << std::endl;
+            return MAX_COUNTERS - 1;
+        }
+        counterNames.push_back(name);
+        counters.emplace_back();
+        return (int)counterNames.size() - 1;
+    }
+
+    // Значение счётчика в текущем кадре
+    void count(int id, double value) {
+        slots[slot].counted[id] = true;
+        slots[slot].counterValues[id] = value;
+    }
+
+    // CSV: кадр, cpu_ms и gpu_ms каждой области (gpu пусто, если запрос не успел), затем счётчики
+    bool openCsv(const std::string& path) {
+        csv.open(path);
+        if (!csv) {
+            std::cerr << "ERROR::PROFILER::FILE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        csvHeader = false;
+        return true;
+    }
+
+    void beginFrame() {
+        slot = (int)(frame % LATENCY);
+        collect(slot, false);
+        slots[slot].frame = frame;
+        frameOpen = true;
+        begin(0);
+    }
+
+    void endFrame() {
+        end(0);
+        frameOpen = false;
+        frame++;
+    }
+
+    // В конце работы: последние LATENCY завершённых кадров ещё в слотах - забираем,
+    // дожидаясь GPU, чтобы они попали в статистику и CSV. Незакрытый кадр
+    // (выход из цикла посреди кадра) отбрасывается
+    void finish() {
+        const uint64_t first = frame > LATENCY ? frame - LATENCY : 0;
+        for (uint64_t f = first; f < frame; f++) {
+            int index = (int)(f % LATENCY);
+            if (frameOpen && index == slot)
+                continue;
+            collect(index, true);
+        }
+        if (frameOpen) {
+            for (size_t i = 0; i < MAX_SCOPES; i++)
+                slots[slot].used[i] = false;
+            for (size_t i = 0; i < MAX_COUNTERS; i++)
+                slots[slot].counted[i] = false;
+            frameOpen = false;
+        }
+        if (csv.is_open())
+            csv.flush();
+    }
+
+    void begin(int id) {
+        Slot& s = slots[slot];
+        s.used[id] = true;
+        s.cpuStart[id] = std::chrono::steady_clock::now();
+        glQueryCounter(queries[slot][id][0], GL_TIMESTAMP);
+    }
+
+    void end(int id) {
+        Slot& s = slots[slot];
+        auto now = std::chrono::steady_clock::now();
+        s.cpuMs[id] = std::chrono::duration<double, std::milli>(now - s.cpuStart[id]).count();
+        glQueryCounter(queries[slot][id][1], GL_TIMESTAMP);
+#ifdef LAB7_TRACE
+        if (Trace::enabled()) {
+            int64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(s.cpuStart[id].time_since_epoch()).count();
+            Trace::threadBuffer().push({ traceNames[id], start,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - s.cpuStart[id]).count() });
+        }
+#endif
+    }
+
+    size_t scopeCount() const { return names.size(); }
+    const std::string& name(int id) const { return names[id]; }
+    const RollingStats& cpuStats(int id) const { return cpu[id]; }
+    const RollingStats& gpuStats(int id) const { return gpu[id]; }
+    uint64_t lateQueries() const { return late; }
+
+    // Таблица min / avg / p99 в мс
+    void print(std::ostream& out) const {
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+        out << "scope            cpu min/avg/p99          gpu min/avg/p99" << std::endl;
+        for (size_t i = 0; i < names.size(); i++) {
+            double cMin, cAvg, cP99, gMin, gAvg, gP99;
+            cpu[i].compute(cMin, cAvg, cP99);
+            gpu[i].compute(gMin, gAvg, gP99);
+            out << std::left << std::setw(16) << names[i] << std::right
+                << std::setw(8) << cMin << std::setw(8) << cAvg << std::setw(8) << cP99 << "   "
+                << std::setw(8) << gMin << std::setw(8) << gAvg << std::setw(8) << gP99 << std::endl;
+        }
+        out << "late GPU queries: " << late << std::endl;
+        if (!counterNames.empty()) {
+            out << std::setprecision(1);
+            out << "counter          min/avg/p99 per frame" << std::endl;
+            for (size_t i = 0; i < counterNames.size(); i++) {
+                double cMin, cAvg, cP99;
+                counters[i].compute(cMin, cAvg, cP99);
+                out << std::left << std::setw(16) << counterNames[i] << std::right
+                    << std::setw(10) << cMin << std::setw(10) << cAvg << std::setw(10) << cP99 << std::endl;
+            }
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+    struct Slot {
+        uint64_t frame = 0;
+        bool used[MAX_SCOPES] = {};
+        std::chrono::steady_clock::time_point cpuStart[MAX_SCOPES];
+        double cpuMs[MAX_SCOPES] = {};
+        bool counted[MAX_COUNTERS] = {};
+        double counterValues[MAX_COUNTERS] = {};
+    };
+
+    std::vector<std::string> names;
+    std::vector<RollingStats> cpu, gpu;
+    std::vector<std::string> counterNames;
+    std::vector<RollingStats> counters;
+    unsigned int queries[LATENCY][MAX_SCOPES][2] = {};
+    Slot slots[LATENCY];
+    int slot = 0;
+    uint64_t frame = 0;
+    bool frameOpen = false;
+    uint64_t late = 0;
+    std::ofstream csv;
+    bool csvHeader = false;
+#ifdef LAB7_TRACE
+    const char* traceNames[MAX_SCOPES] = {};
+    Trace::ThreadBuffer* gpuTrack = nullptr;
+    int64_t gpuOffsetNs = 0;
+#endif
+
+    // Результаты кадра, записанного в этот слот LATENCY кадров назад;
+    // wait - ждать GPU вместо того, чтобы считать неготовый запрос опоздавшим
+    void collect(int index, bool wait) {
+        Slot& s = slots[index];
+        bool any = false;
+        double gpuMs[MAX_SCOPES];
+        bool gpuReady[MAX_SCOPES] = {};
+        for (size_t i = 0; i < names.size(); i++) {
+            if (!s.used[i])
+                continue;
+            any = true;
+            cpu[i].add(s.cpuMs[i]);
+            GLint available = 0;
+            if (!wait)
+                glGetQueryObjectiv(queries[index][i][1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!wait && !available) {
+                late++;
+                continue;
+            }
+            GLuint64 start = 0, stop = 0;
+            glGetQueryObjectui64v(queries[index][i][0], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(queries[index][i][1], GL_QUERY_RESULT, &stop);
+            gpuMs[i] = (stop - start) * 1e-6;
+            gpuReady[i] = true;
+            gpu[i].add(gpuMs[i]);
+#ifdef LAB7_TRACE
+            if (Trace::enabled())
+                gpuTrack->push({ traceNames[i], (int64_t)start + gpuOffsetNs, (int64_t)(stop - start) });
+#endif
+        }
+        for (size_t i = 0; i < counterNames.size(); i++) {
+            if (s.counted[i])
+                counters[i].add(s.counterValues[i]);
+        }
+        if (any && csv.is_open())
+            writeCsv(s, gpuMs, gpuReady);
+        for (size_t i = 0; i < MAX_SCOPES; i++)
+            s.used[i] = false;
+        for (size_t i = 0; i < MAX_COUNTERS; i++)
+            s.counted[i] = false;
+    }
+
+    void writeCsv(const Slot& s, const double* gpuMs, const bool* gpuReady) {
+        if (!csvHeader) {
+            csv << "frame";
+            for (const std::string& n : names)
+                csv << "," << n << "_cpu_ms," << n << "_gpu_ms";
+            for (const std::string& n : counterNames)
+                csv << "," << n;
+            csv << "\n";
+            csvHeader = true;
+        }
+        csv << s.frame;
+        for (size_t i = 0; i < names.size(); i++) {
+            csv << ",";
+            if (s.used[i])
+                csv << s.cpuMs[i];
+            csv << ",";
+            if (gpuReady[i])
+                csv << gpuMs[i];
+        }
+        for (size_t i = 0; i < counterNames.size(); i++) {
+            csv << ",";
+            if (s.counted[i])
+                csv << s.counterValues[i];
+        }
+        csv << "\n";
+    }
+};
+
+// Замер области до конца блока
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, int id) : profiler(profiler), id(id) {
+        profiler.begin(id);
+    }
+
+    ~ProfileScope() {
+        profiler.end(id);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    int id;
+};
+
+// Полосы профилировщика в левом верхнем углу экрана: по строке на область,
+// CPU (синяя) и GPU (оранжевая) - среднее, светлая засечка - p99.
+// Шкала - 2 кадра по 60 Гц, красная вертикаль - бюджет кадра 16.7 мс
+class ProfilerOverlay {
+public:
+    ProfilerOverlay() : shader("profiler_vertex.glsl", "profiler_fragment.glsl"), stream(MAX_VERTICES * sizeof(Vertex)) {
+        glCreateVertexArrays(1, &VAO);
+        gpuMemory().vertexArrays++;
+        glEnableVertexArrayAttrib(VAO, 0);
+        glVertexArrayAttribFormat(VAO, 0, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, position));
+        glVertexArrayAttribBinding(VAO, 0, 0);
+        glEnableVertexArrayAttrib(VAO, 1);
+        glVertexArrayAttribFormat(VAO, 1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, color));
+        glVertexArrayAttribBinding(VAO, 1, 0);
+    }
+
+    ~ProfilerOverlay() {
+        GLCalls::deleteVertexArray(VAO);
+        gpuMemory().vertexArrays--;
+    }
+
+    ProfilerOverlay(const ProfilerOverlay&) = delete;
+    ProfilerOverlay& operator=(const ProfilerOverlay&) = delete;
+
+    void Draw(const FrameProfiler& profiler) {
+        vertices.clear();
+        const float left = -0.98f, top = 0.95f, width = 0.9f, row = 0.05f;
+        const double scaleMs = 2.0 * 1000.0 / 60.0;
+        const float budget = left + width * (float)(1000.0 / 60.0 / scaleMs);
+        const float bottom = top - row * profiler.scopeCount();
+
+        quad(left, bottom, left + width, top, glm::vec3(0.1f));
+        for (size_t i = 0; i < profiler.scopeCount(); i++) {
+            float y = top - row * (i + 1);
+            bar(profiler.cpuStats((int)i), left, y + row * 0.5f, y + row * 0.9f, width, scaleMs, glm::vec3(0.2f, 0.5f, 1.0f));
+            bar(profiler.gpuStats((int)i), left, y + row * 0.1f, y + row * 0.5f, width, scaleMs, glm::vec3(1.0f, 0.6f, 0.1f));
+        }
+        quad(budget - 0.002f, bottom, budget + 0.002f, top, glm::vec3(1.0f, 0.1f, 0.1f));
+
+        const size_t count = std::min(vertices.size(), (size_t)MAX_VERTICES);
+        std::memcpy(stream.map(count * sizeof(Vertex)), vertices.data(), count * sizeof(Vertex));
+        glVertexArrayVertexBuffer(VAO, 0, stream.ID, stream.offset(), sizeof(Vertex));
+
+        bool depth = GLCalls::isEnabled(GL_DEPTH_TEST);
+        GLCalls::setCapability(GL_DEPTH_TEST, false);
+        shader.use();
+        GLCalls::bindVertexArray(VAO);
+        GLCalls::drawArrays(GL_TRIANGLES, 0, (GLsizei)count);
+        GLCalls::setCapability(GL_DEPTH_TEST, depth);
+        stream.fence();
+    }
+
+private:
+    struct Vertex {
+        glm::vec2 position;
+        glm::vec3 color;
+    };
+
+    // Фон, по две полосы и засечке на область, линия бюджета - по 6 вершин
+    static const int MAX_VERTICES = (2 + FrameProfiler::MAX_SCOPES * 4) * 6;
+
+    Shader shader;
+    StreamBuffer stream;
+    unsigned int VAO = 0;
+    std::vector<Vertex> vertices;
+
+    void quad(float x0, float y0, float x1, float y1, const glm::vec3& color) {
+        const Vertex v[6] = { { { x0, y0 }, color }, { { x1, y0 }, color }, { { x1, y1 }, color },
+            { { x0, y0 }, color }, { { x1, y1 }, color }, { { x0, y1 }, color } };
+        vertices.insert(vertices.end(), v, v + 6);
+    }
+
+    void bar(const RollingStats& stats, float left, float y0, float y1, float width, double scaleMs, const glm::vec3& color) {
+        double minimum, average, p99;
+        stats.compute(minimum, average, p99);
+        float avgX = left + width * (float)std::min(average / scaleMs, 1.0);
+        float p99X = left + width * (float)std::min(p99 / scaleMs, 1.0);
+        quad(left, y0, avgX, y1, color);
+        quad(p99X - 0.003f, y0, p99X + 0.003f, y1, glm::mix(color, glm::vec3(1.0f), 0.6f));
+    }
+};
+
+#endif // FRAME_PROFILER_H
@@ -0,0 +1,313 @@
+#ifndef GL_CALLS_H
+#define GL_CALLS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <GL/glew.h>
+
+// Счётчики вызовов GL за кадр. Запрошенные привязки считаются все, "лишние" -
+// привязка того, что уже привязано: такие в GL не уходят (elided). Отвязки (VAO 0)
+// считаются отдельно: каждый вызов рисования привязывает свой VAO сам, так что
+// отвязка после него - чистые накладные расходы.
+struct GLCallStats {
+    uint64_t drawCalls = 0;              // вызовов glDraw* / glMultiDraw*
+    uint64_t drawCommands = 0;           // отдельных рисований (команд в multi-draw)
+    uint64_t programBinds = 0;
+    uint64_t redundantProgramBinds = 0;
+    uint64_t vertexArrayBinds = 0;
+    uint64_t redundantVertexArrayBinds = 0;
+    uint64_t vertexArrayUnbinds = 0;
+    uint64_t bufferBinds = 0;
+    uint64_t redundantBufferBinds = 0;
+    uint64_t textureBinds = 0;
+    uint64_t redundantTextureBinds = 0;
+    uint64_t capabilityChanges = 0;      // glEnable / glDisable
+    uint64_t redundantCapabilityChanges = 0;
+    uint64_t uniformCalls = 0;
+    uint64_t uniformBytes = 0;
+    uint64_t bufferUploads = 0;          // glNamedBufferSubData и записи в отображённые буферы
+    uint64_t bufferUploadBytes = 0;
+
+    uint64_t binds() const { return programBinds + vertexArrayBinds + bufferBinds + textureBinds; }
+    uint64_t redundantBinds() const {
+        return redundantProgramBinds + redundantVertexArrayBinds + vertexArrayUnbinds + redundantBufferBinds +
+            redundantTextureBinds;
+    }
+    // Вызовы, которые кэш состояния не отправил в GL
+    uint64_t elided() const {
+        return redundantProgramBinds + redundantVertexArrayBinds + redundantBufferBinds + redundantTextureBinds +
+            redundantCapabilityChanges;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const GLCallStats& stats) {
+    return out << stats.drawCalls << " draws (" << stats.drawCommands << " commands), "
+        << stats.programBinds << " program binds (" << stats.redundantProgramBinds << " redundant), "
+        << stats.vertexArrayBinds << " VAO binds (" << stats.redundantVertexArrayBinds << " redundant, "
+        << stats.vertexArrayUnbinds << " unbinds), "
+        << stats.bufferBinds << " buffer binds (" << stats.redundantBufferBinds << " redundant), "
+        << stats.textureBinds << " texture binds (" << stats.redundantTextureBinds << " redundant), "
+        << stats.capabilityChanges << " enable/disable (" << stats.redundantCapabilityChanges << " redundant), "
+        << stats.elided() << " calls elided, "
+        << stats.uniformCalls << " uniforms (" << stats.uniformBytes << " B), "
+        << stats.bufferUploads << " uploads (" << stats.bufferUploadBytes / 1024.0 << " KB)";
+}
+
+// Обёртки над вызовами GL, через которые идут все привязки, рисования и загрузки
+// uniform-ов приложения. Заодно это кэш состояния: привязанные программа, VAO,
+// буферы, текстуры и включённые режимы повторяются на CPU (bound()), и вызов,
+// ничего не меняющий, в GL не уходит. Поэтому отвязывать после рисования не нужно,
+// а мимо обёрток эти функции GL вызывать нельзя - копия разойдётся с контекстом.
+// Начальные значения - умолчания GL для нового контекста.
+namespace GLCalls {
+    const unsigned int MAX_INDEXED_BINDINGS = 16;
+    const unsigned int MAX_TEXTURE_UNITS = 16;
+
+    struct IndexedBinding {
+        GLuint buffer = 0;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;  // 0 - весь буфер (glBindBufferBase)
+    };
+
+    struct BoundState {
+        GLuint program = 0;
+        GLuint vertexArray = 0;
+        GLuint drawIndirectBuffer = 0;
+        IndexedBinding uniformBuffers[MAX_INDEXED_BINDINGS];
+        IndexedBinding storageBuffers[MAX_INDEXED_BINDINGS];
+        GLuint textures[MAX_TEXTURE_UNITS] = {};
+        bool depthTest = false;
+        bool programPointSize = false;
+        bool rasterizerDiscard = false;
+    };
+
+    // Счётчики текущего кадра; цикл отрисовки обнуляет их в начале кадра
+    inline GLCallStats& stats() {
+        static GLCallStats s;
+        return s;
+    }
+
+    inline BoundState& bound() {
+        static BoundState s;
+        return s;
+    }
+
+    inline IndexedBinding* indexedBinding(GLenum target, GLuint index) {
+        if (index >= MAX_INDEXED_BINDINGS)
+            return nullptr;
+        if (target == GL_UNIFORM_BUFFER)
+            return &bound().uniformBuffers[index];
+        if (target == GL_SHADER_STORAGE_BUFFER)
+            return &bound().storageBuffers[index];
+        return nullptr;
+    }
+
+    inline bool* capability(GLenum cap) {
+        switch (cap) {
+        case GL_DEPTH_TEST: return &bound().depthTest;
+        case GL_PROGRAM_POINT_SIZE: return &bound().programPointSize;
+        case GL_RASTERIZER_DISCARD: return &bound().rasterizerDiscard;
+        default: return nullptr;
+        }
+    }
+
+    inline void useProgram(GLuint program) {
+        GLCallStats& s = stats();
+        s.programBinds++;
+        if (bound().program == program) {
+            s.redundantProgramBinds++;
+            return;
+        }
+        bound().program = program;
+        glUseProgram(program);
+    }
+
+    inline void bindVertexArray(GLuint vertexArray) {
+        GLCallStats& s = stats();
+        s.vertexArrayBinds++;
+        if (bound().vertexArray == vertexArray) {
+            s.redundantVertexArrayBinds++;
+            return;
+        }
+        if (vertexArray == 0)
+            s.vertexArrayUnbinds++;
+        bound().vertexArray = vertexArray;
+        glBindVertexArray(vertexArray);
+    }
+
+    inline void bindBuffer(GLenum target, GLuint buffer) {
+        GLCallStats& s = stats();
+        s.bufferBinds++;
+        if (target == GL_DRAW_INDIRECT_BUFFER) {
+            if (bound().drawIndirectBuffer == buffer) {
+                s.redundantBufferBinds++;
+                return;
+            }
+            bound().drawIndirectBuffer = buffer;
+        }
+        glBindBuffer(target, buffer);
+    }
+
+    inline void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        GLCallStats& s = stats();
+        s.bufferBinds++;
+        if (IndexedBinding* b = indexedBinding(target, index)) {
+            if (b->buffer == buffer && b->size == 0) {
+                s.redundantBufferBinds++;
+                return;
+            }
+            b->buffer = buffer;
+            b->offset = 0;
+            b->size = 0;
+        }
+        glBindBufferBase(target, index, buffer);
+    }
+
+    inline void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+        GLCallStats& s = stats();
+        s.bufferBinds++;
+        if (IndexedBinding* b = indexedBinding(target, index)) {
+            if (b->buffer == buffer && b->offset == offset && b->size == size) {
+                s.redundantBufferBinds++;
+                return;
+            }
+            b->buffer = buffer;
+            b->offset = offset;
+            b->size = size;
+        }
+        glBindBufferRange(target, index, buffer, offset, size);
+    }
+
+    inline void bindTextureUnit(GLuint unit, GLuint texture) {
+        GLCallStats& s = stats();
+        s.textureBinds++;
+        if (unit < MAX_TEXTURE_UNITS) {
+            if (bound().textures[unit] == texture) {
+                s.redundantTextureBinds++;
+                return;
+            }
+            bound().textures[unit] = texture;
+        }
+        glBindTextureUnit(unit, texture);
+    }
+
+    // glEnable / glDisable; режимы вне кэша уходят в GL всегда
+    inline void setCapability(GLenum cap, bool enabled) {
+        GLCallStats& s = stats();
+        s.capabilityChanges++;
+        if (bool* cached = capability(cap)) {
+            if (*cached == enabled) {
+                s.redundantCapabilityChanges++;
+                return;
+            }
+            *cached = enabled;
+        }
+        if (enabled)
+            glEnable(cap);
+        else
+            glDisable(cap);
+    }
+
+    // Вместо glIsEnabled: запрос к контексту может остановить конвейер драйвера
+    inline bool isEnabled(GLenum cap) {
+        bool* cached = capability(cap);
+        return cached != nullptr ? *cached : glIsEnabled(cap) == GL_TRUE;
+    }
+
+    // Удалённый объект больше не считается привязанным (GL отвязывает его сам)
+    inline void deleteVertexArray(GLuint& vertexArray) {
+        if (bound().vertexArray == vertexArray)
+            bound().vertexArray = 0;
+        glDeleteVertexArrays(1, &vertexArray);
+    }
+
+    inline void deleteTexture(GLuint& texture) {
+        for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+            if (bound().textures[i] == texture)
+                bound().textures[i] = 0;
+        }
+        glDeleteTextures(1, &texture);
+    }
+
+    inline void deleteBuffer(GLuint& buffer) {
+        BoundState& b = bound();
+        if (b.drawIndirectBuffer == buffer)
+            b.drawIndirectBuffer = 0;
+        for (unsigned int i = 0; i < MAX_INDEXED_BINDINGS; i++) {
+            if (b.uniformBuffers[i].buffer == buffer)
+                b.uniformBuffers[i] = IndexedBinding();
+            if (b.storageBuffers[i].buffer == buffer)
+                b.storageBuffers[i] = IndexedBinding();
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+
+    inline void drawArrays(GLenum mode, GLint first, GLsizei count) {
+        stats().drawCalls++;
+        stats().drawCommands++;
+        glDrawArrays(mode, first, count);
+    }
+
+    inline void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void* indices, GLint baseVertex) {
+        stats().drawCalls++;
+        stats().drawCommands++;
+        glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    }
+
+    inline void drawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices,
+        GLsizei instanceCount, GLint baseVertex, GLuint baseInstance) {
+        stats().drawCalls++;
+        stats().drawCommands++;
+        glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instanceCount, baseVertex, baseInstance);
+    }
+
+    inline void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride) {
+        stats().drawCalls++;
+        stats().drawCommands += drawCount;
+        glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    }
+
+    inline void countUniform(size_t bytes) {
+        stats().uniformCalls++;
+        stats().uniformBytes += bytes;
+    }
+
+    inline void uniform1i(GLint location, GLint value) {
+        countUniform(sizeof(GLint));
+        glUniform1i(location, value);
+    }
+
+    inline void uniform1f(GLint location, GLfloat value) {
+        countUniform(sizeof(GLfloat));
+        glUniform1f(location, value);
+    }
+
+    inline void uniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+        countUniform(count * 3 * sizeof(GLfloat));
+        glUniform3fv(location, count, value);
+    }
+
+    inline void uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+        countUniform(count * 9 * sizeof(GLfloat));
+        glUniformMatrix3fv(location, count, transpose, value);
+    }
+
+    inline void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+        countUniform(count * 16 * sizeof(GLfloat));
+        glUniformMatrix4fv(location, count, transpose, value);
+    }
+
+    // Запись CPU в отображённый буфер (StreamBuffer) - тоже загрузка
+    inline void countUpload(size_t bytes) {
+        stats().bufferUploads++;
+        stats().bufferUploadBytes += bytes;
+    }
+
+    inline void namedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+        countUpload((size_t)size);
+        glNamedBufferSubData(buffer, offset, size, data);
+    }
+}
+
+#endif // GL_CALLS_H
@@ -0,0 +1,35 @@
+#ifndef GPU_MEMORY_H
+#define GPU_MEMORY_H
+
+#include <cstdint>
+#include <iostream>
+
+// Учёт живых GL-объектов и байт в буферах, созданных приложением.
+// После выгрузки модели числа должны вернуться к прежним - иначе утечка.
+struct GpuMemoryStats {
+    int64_t bufferBytes = 0;
+    int64_t buffers = 0;
+    int64_t vertexArrays = 0;
+};
+
+inline GpuMemoryStats& gpuMemory() {
+    static GpuMemoryStats stats;
+    return stats;
+}
+
+inline void trackBufferCreated(int64_t bytes) {
+    gpuMemory().bufferBytes += bytes;
+    gpuMemory().buffers++;
+}
+
+inline void trackBufferDeleted(int64_t bytes) {
+    gpuMemory().bufferBytes -= bytes;
+    gpuMemory().buffers--;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const GpuMemoryStats& stats) {
+    return out << stats.bufferBytes / 1024.0 << " KB in " << stats.buffers << " buffers, "
+        << stats.vertexArrays << " VAOs";
+}
+
+#endif // GPU_MEMORY_H
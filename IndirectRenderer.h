@@ -0,0 +1,136 @@
+#ifndef INDIRECT_RENDERER_H
+#define INDIRECT_RENDERER_H
+
+#include <vector>
+#include <glm.hpp>
+#include <GL/glew.h>
+
+#include "Model.h"
+#include "StreamBuffer.h"
+#include "GpuMemory.h"
+#include "GLCalls.h"
+
+// Точки привязки SSBO (пространство имён отдельное от uniform-блоков)
+enum StorageBinding : unsigned int {
+    PART_TRANSFORMS_BINDING = 0
+};
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// std430: mat3 хранится как три vec4
+struct PartTransform {
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];
+};
+
+static_assert(sizeof(PartTransform) == 112, "PartTransform must match std430 layout");
+
+// Вся модель (или много её копий) одним glMultiDrawElementsIndirect.
+// Преобразования частей идут в SSBO, шейдер выбирает своё по gl_DrawID
+// (vertex_indirect.glsl). Команды не меняются от кадра к кадру и
+// перестраиваются только при смене модели или числа копий.
+class IndirectRenderer {
+public:
+    IndirectRenderer() {}
+
+    ~IndirectRenderer() {
+        releaseCommands();
+    }
+
+    IndirectRenderer(const IndirectRenderer&) = delete;
+    IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+    // instanceTransforms - положение каждой копии; части берут model.meshTransforms.
+    // transformsChanged = false: преобразования те же, что в прошлом кадре - SSBO не переписывается
+    void Draw(const Model& model, const glm::mat4* instanceTransforms, size_t instanceCount,
+        bool transformsChanged = true) {
+        const size_t meshCount = model.meshes.size();
+        const size_t drawCount = meshCount * instanceCount;
+        if (drawCount == 0)
+            return;
+
+        bool commandsRebuilt = updateCommands(model, instanceCount);
+        if (transformsChanged || commandsRebuilt || !transformsUploaded)
+            uploadTransforms(model, instanceTransforms, instanceCount);
+
+        transforms.bindRange(GL_SHADER_STORAGE_BUFFER, PART_TRANSFORMS_BINDING);
+        GLCalls::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        GLCalls::bindVertexArray(model.arena.VAO);
+        GLCalls::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)drawCount, 0);
+        transforms.fence();
+    }
+
+private:
+    StreamBuffer transforms;
+    bool transformsUploaded = false;
+    unsigned int commandBuffer = 0;
+    size_t commandBytes = 0;
+    size_t commandGeneration = 0;
+    size_t commandInstances = 0;
+    size_t commandMeshes = 0;
+
+    void uploadTransforms(const Model& model, const glm::mat4* instanceTransforms, size_t instanceCount) {
+        const size_t meshCount = model.meshes.size();
+        PartTransform* parts = static_cast<PartTransform*>(transforms.map(meshCount * instanceCount * sizeof(PartTransform)));
+        for (size_t inst = 0; inst < instanceCount; inst++) {
+            for (size_t m = 0; m < meshCount; m++) {
+                PartTransform& part = parts[inst * meshCount + m];
+                part.model = instanceTransforms[inst] * model.meshTransforms[m];
+                glm::mat3 normal = computeNormalMatrix(part.model);
+                part.normalMatrix[0] = glm::vec4(normal[0], 0.0f);
+                part.normalMatrix[1] = glm::vec4(normal[1], 0.0f);
+                part.normalMatrix[2] = glm::vec4(normal[2], 0.0f);
+            }
+        }
+        transformsUploaded = true;
+    }
+
+    // true, если команды пришлось перестроить
+    bool updateCommands(const Model& model, size_t instanceCount) {
+        if (commandBuffer != 0 && commandGeneration == model.loadGeneration &&
+            commandInstances == instanceCount && commandMeshes == model.meshes.size())
+            return false;
+
+        std::vector<DrawElementsIndirectCommand> commands;
+        commands.reserve(model.meshes.size() * instanceCount);
+        for (size_t inst = 0; inst < instanceCount; inst++) {
+            for (size_t m = 0; m < model.meshes.size(); m++) {
+                const Mesh& mesh = model.meshes[m];
+                DrawElementsIndirectCommand cmd;
+                cmd.count = mesh.indexCount;
+                cmd.instanceCount = 1;
+                cmd.firstIndex = mesh.firstIndex;
+                cmd.baseVertex = (GLint)mesh.baseVertex;
+                cmd.baseInstance = 0;
+                commands.push_back(cmd);
+            }
+        }
+
+        releaseCommands();
+        commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+        glCreateBuffers(1, &commandBuffer);
+        glNamedBufferStorage(commandBuffer, commandBytes, commands.data(), 0);
+        trackBufferCreated(commandBytes);
+        commandGeneration = model.loadGeneration;
+        commandInstances = instanceCount;
+        commandMeshes = model.meshes.size();
+        return true;
+    }
+
+    void releaseCommands() {
+        if (commandBuffer == 0)
+            return;
+        GLCalls::deleteBuffer(commandBuffer);
+        trackBufferDeleted(commandBytes);
+        commandBuffer = 0;
+        commandBytes = 0;
+    }
+};
+
+#endif // INDIRECT_RENDERER_H
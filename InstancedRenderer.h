@@ -0,0 +1,57 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include <vector>
+#include <glm.hpp>
+#include <GL/glew.h>
+
+#include "Model.h"
+#include "Kinematics.h"
+#include "IndirectRenderer.h"
+#include "StreamBuffer.h"
+#include "GLCalls.h"
+
+// Парк одинаковых манипуляторов, у каждого свои углы суставов.
+// Преобразования частей всех экземпляров считаются пачкой и пишутся в SSBO
+// по частям (сначала часть 0 всех экземпляров, потом часть 1 ...), после чего
+// каждая часть рисуется одним glDrawElementsInstanced* на все экземпляры.
+// Шейдер (vertex_instanced.glsl) берёт parts[gl_BaseInstance + gl_InstanceID].
+class InstancedRenderer {
+public:
+    void Draw(const Model& model, const KinematicTree& kinematics,
+        const glm::mat4* instanceTransforms, const JointState* states, size_t instanceCount) {
+        const size_t partCount = model.meshes.size();
+        if (partCount == 0 || instanceCount == 0)
+            return;
+
+        scratch.resize(partCount);
+        PartTransform* parts = static_cast<PartTransform*>(transforms.map(partCount * instanceCount * sizeof(PartTransform)));
+        for (size_t inst = 0; inst < instanceCount; inst++) {
+            kinematics.computePartTransforms(states[inst], scratch.data(), partCount);
+            for (size_t p = 0; p < partCount; p++) {
+                PartTransform& part = parts[p * instanceCount + inst];
+                part.model = instanceTransforms[inst] * scratch[p];
+                glm::mat3 normal = computeNormalMatrix(part.model);
+                part.normalMatrix[0] = glm::vec4(normal[0], 0.0f);
+                part.normalMatrix[1] = glm::vec4(normal[1], 0.0f);
+                part.normalMatrix[2] = glm::vec4(normal[2], 0.0f);
+            }
+        }
+
+        transforms.bindRange(GL_SHADER_STORAGE_BUFFER, PART_TRANSFORMS_BINDING);
+        GLCalls::bindVertexArray(model.arena.VAO);
+        for (size_t p = 0; p < partCount; p++) {
+            const Mesh& mesh = model.meshes[p];
+            GLCalls::drawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                (void*)(mesh.firstIndex * sizeof(unsigned int)), (GLsizei)instanceCount,
+                (GLint)mesh.baseVertex, (GLuint)(p * instanceCount));
+        }
+        transforms.fence();
+    }
+
+private:
+    StreamBuffer transforms;
+    std::vector<glm::mat4> scratch;
+};
+
+#endif // INSTANCED_RENDERER_H
@@ -0,0 +1,156 @@
+#ifndef INVERSE_KINEMATICS_H
+#define INVERSE_KINEMATICS_H
+
+#include <cmath>
+#include <glm.hpp>
+
+#include "Kinematics.h"
+
+struct IKSettings {
+    int maxIterations = 64;
+    float tolerance = 1e-4f;     // допустимый промах рабочей точки, единицы модели
+    float damping = 0.05f;       // lambda в (J J^T + lambda^2 I)
+    float maxStepDegrees = 15.0f; // ограничение шага сустава за итерацию
+    int restarts = 8;            // повторы с других начальных поз, если застряли у пределов
+};
+
+struct IKResult {
+    bool converged = false;
+    int iterations = 0;
+    float error = 0.0f;          // итоговое расстояние до цели
+};
+
+// Один спуск из state (см. solveIK)
+inline IKResult solveIKFrom(const KinematicTree& tree, const glm::vec3& target, JointState& state,
+    const IKSettings& settings) {
+    IKResult result;
+    const int toolJoint = tree.toolJoint;
+    if (toolJoint < 0)
+        return result;
+
+    // На рабочую точку влияют только суставы цепочки от инструмента до корня
+    bool inChain[MAX_JOINTS] = {};
+    for (int j = toolJoint; j >= 0; j = tree.joints[j].parent)
+        inChain[j] = true;
+
+    const size_t jointCount = tree.jointCount();
+    const float maxStep = glm::radians(settings.maxStepDegrees);
+    RigidTransform world[MAX_JOINTS];
+    glm::vec3 columns[MAX_JOINTS];
+
+    float lambda2 = settings.damping * settings.damping;
+    JointState accepted = state;
+    float acceptedError = -1.0f;
+
+    for (;;) {
+        tree.evaluate(state, world);
+        glm::vec3 tool = world[toolJoint].applyPoint(tree.toolPoint);
+        glm::vec3 error = target - tool;
+        float distance = glm::length(error);
+        // Шаг увеличил промах - откат и сильнее демпфирование, иначе - слабее (Левенберг-Марквардт)
+        if (acceptedError >= 0.0f && distance > acceptedError) {
+            state = accepted;
+            lambda2 *= 4.0f;
+            tree.evaluate(state, world);
+            tool = world[toolJoint].applyPoint(tree.toolPoint);
+            error = target - tool;
+            distance = acceptedError;
+        }
+        else {
+            accepted = state;
+            acceptedError = distance;
+            lambda2 = std::max(lambda2 * 0.5f, 1e-6f);
+        }
+        result.error = distance;
+        if (result.error <= settings.tolerance) {
+            result.converged = true;
+            break;
+        }
+        if (result.iterations == settings.maxIterations)
+            break;
+        result.iterations++;
+
+        // Ось и опора не меняются от поворота собственного сустава
+        for (size_t j = 0; j < jointCount; j++) {
+            if (!inChain[j])
+                continue;
+            const Joint& joint = tree.joints[j];
+            glm::vec3 axis = world[j].applyVector(joint.axis);
+            glm::vec3 pivot = world[j].applyPoint(joint.pivot);
+            columns[j] = glm::cross(axis, tool - pivot);
+        }
+
+        // Сустав, упёршийся в предел и толкаемый за него, исключается из якобиана,
+        // и шаг пересчитывается по остальным - иначе решение залипает на пределе
+        bool active[MAX_JOINTS];
+        for (size_t j = 0; j < jointCount; j++)
+            active[j] = inChain[j];
+        float step[MAX_JOINTS] = {};
+        for (size_t pass = 0; pass <= jointCount; pass++) {
+            glm::mat3 jjt(lambda2);
+            for (size_t j = 0; j < jointCount; j++) {
+                if (active[j])
+                    jjt += glm::outerProduct(columns[j], columns[j]);
+            }
+            glm::vec3 y = glm::inverse(jjt) * error;
+
+            bool blocked = false;
+            for (size_t j = 0; j < jointCount; j++) {
+                if (!active[j])
+                    continue;
+                step[j] = glm::clamp(glm::dot(columns[j], y), -maxStep, maxStep);
+                const Joint& joint = tree.joints[j];
+                if ((step[j] < 0.0f && state.angles[j] <= joint.minAngle) ||
+                    (step[j] > 0.0f && state.angles[j] >= joint.maxAngle)) {
+                    active[j] = false;
+                    step[j] = 0.0f;
+                    blocked = true;
+                }
+            }
+            if (!blocked)
+                break;
+        }
+
+        for (size_t j = 0; j < jointCount; j++)
+            state.angles[j] += glm::degrees(step[j]);
+        tree.clamp(state);
+    }
+    return result;
+}
+
+// Положение рабочей точки (tool в manipulator.kin) в target методом
+// демпфированных наименьших квадратов: dq = J^T (J J^T + lambda^2 I)^-1 e.
+// Якобиан только по положению (3 x n): столбец сустава - ось x (точка - опора)
+// в мировых координатах. После каждого шага углы зажимаются в пределы суставов.
+// state - начальное приближение (для слежения - решение прошлого цикла), в нём же ответ.
+// Пределы создают локальные минимумы (нужная ветвь "локоть вверх/вниз" закрыта
+// пределом), поэтому при неудаче спуск повторяется из поз, равномерно разбросанных
+// по пределам, и остаётся лучший результат.
+inline IKResult solveIK(const KinematicTree& tree, const glm::vec3& target, JointState& state,
+    const IKSettings& settings = IKSettings()) {
+    JointState best = state;
+    IKResult result = solveIKFrom(tree, target, best, settings);
+    int iterations = result.iterations;
+    for (int r = 1; r <= settings.restarts && !result.converged; r++) {
+        // Последовательность Вейля: для сустава j шаг - дробная часть r * sqrt(простого)
+        static const float STEP[MAX_JOINTS] = { 0.4142136f, 0.7320508f, 0.2360680f, 0.6457513f,
+            0.3166248f, 0.6055513f, 0.1231056f, 0.3588989f };
+        JointState seed = state;
+        for (size_t j = 0; j < tree.jointCount(); j++) {
+            float t = r * STEP[j];
+            t -= std::floor(t);
+            seed.angles[j] = tree.joints[j].minAngle + t * (tree.joints[j].maxAngle - tree.joints[j].minAngle);
+        }
+        IKResult attempt = solveIKFrom(tree, target, seed, settings);
+        iterations += attempt.iterations;
+        if (attempt.error < result.error) {
+            result = attempt;
+            best = seed;
+        }
+    }
+    result.iterations = iterations;
+    state = best;
+    return result;
+}
+
+#endif // INVERSE_KINEMATICS_H
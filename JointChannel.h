@@ -0,0 +1,207 @@
+#ifndef JOINT_CHANNEL_H
+#define JOINT_CHANNEL_H
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+
+#include "Kinematics.h"
+#include "SharedMemory.h"
+
+#if ATOMIC_LLONG_LOCK_FREE != 2 || ATOMIC_INT_LOCK_FREE != 2
+#error "JointChannel needs address-free lock-free atomics in shared memory"
+#endif
+
+// Имя канала по умолчанию (Lab_7 --produce / Lab_7 --controller)
+const char* const JOINT_CHANNEL_NAME = "lab7_joints";
+
+// Время, общее для процессов одной машины (CLOCK_MONOTONIC / QueryPerformanceCounter)
+inline int64_t channelClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct JointSample {
+    int64_t timestampNs = 0;   // channelClockNs() у производителя
+    uint32_t jointCount = 0;
+    float angles[MAX_JOINTS] = {};
+};
+
+// Канал углов суставов от внешнего контроллера через разделяемую память.
+// Кольцо из CAPACITY слотов, каждый под своим seqlock: писатель делает номер
+// слота нечётным, пишет, делает чётным (2 * индекс + 2) и сдвигает writeIndex.
+// Читатель берёт последний слот и перечитывает, если номер сменился во время
+// копирования. Ни блокировок, ни системных вызовов на стороне чтения; писатель
+// никогда не ждёт читателя (отставший читатель просто видит более свежий слот).
+// Каждый запуск производителя пишет свою эпоху: читатель, увидевший чужую эпоху,
+// убывание writeIndex или долгое отсутствие образцов (alive), переподключается -
+// на POSIX перезапущенный производитель создаёт новый сегмент под тем же именем,
+// а старое отображение у читателя просто перестаёт обновляться.
+class JointChannel {
+public:
+    static const uint32_t CAPACITY = 256;
+
+    // create = true - производитель (создаёт и обнуляет память), иначе - подключение.
+    // Потребитель получает уже записанный последний образец, только если тот моложе
+    // maxSampleAgeSeconds: иначе производитель, остановленный без удаления сегмента,
+    // "оживал" бы при каждом переподключении со старым образцом
+    JointChannel(const std::string& name, bool create, double maxSampleAgeSeconds = 0.0)
+        : memory(name, sizeof(Layout), create) {
+        if (!memory.valid())
+            return;
+        layout = static_cast<Layout*>(memory.data());
+        if (create) {
+            // Отображение, оставшееся открытым у читателя (Windows), не обнуляется:
+            // writeIndex продолжается, сменяется только эпоха
+            if (!memory.existed() || !headerValid())
+                layout->writeIndex.store(0, std::memory_order_relaxed);
+            layout->epoch.store((uint64_t)channelClockNs(), std::memory_order_release);
+            std::memcpy(layout->magic, magic(), 4);
+            layout->version = VERSION;
+            layout->capacity = CAPACITY;
+        }
+        else if (!headerValid()) {
+            layout = nullptr;
+        }
+        else {
+            epoch = layout->epoch.load(std::memory_order_acquire);
+            uint64_t count = layout->writeIndex.load(std::memory_order_acquire);
+            lastRead = count;
+            JointSample last;
+            if (count > 0 && readSlot(count - 1, last) &&
+                channelClockNs() - last.timestampNs < (int64_t)(maxSampleAgeSeconds * 1e9))
+                lastRead = count - 1;  // доступен сразу, пропущенным не считается
+            attachCount = count;
+        }
+        lastSampleNs = channelClockNs();
+    }
+
+    JointChannel(const JointChannel&) = delete;
+    JointChannel& operator=(const JointChannel&) = delete;
+
+    bool valid() const { return layout != nullptr; }
+
+    // Производитель
+    void publish(const JointSample& sample) {
+        uint64_t index = layout->writeIndex.load(std::memory_order_relaxed);
+        Slot& slot = layout->slots[index % CAPACITY];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.sample, &sample, sizeof(JointSample));
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        layout->writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    // Потребитель: true и out, если с прошлого вызова пришёл новый образец
+    bool poll(JointSample& out) {
+        if (!valid())
+            return false;
+        if (layout->epoch.load(std::memory_order_acquire) != epoch) {
+            disconnected = true;
+            return false;
+        }
+        for (int attempt = 0; attempt < 4; attempt++) {
+            uint64_t count = layout->writeIndex.load(std::memory_order_acquire);
+            if (count == lastRead)
+                return false;
+            if (count < lastRead) {
+                disconnected = true;  // память обнулена новым производителем
+                return false;
+            }
+            if (!readSlot(count - 1, out))
+                continue;
+            skipped += count - lastRead - 1;
+            lastRead = count;
+            lastSampleNs = channelClockNs();
+            return true;
+        }
+        return false;
+    }
+
+    // Сколько образцов потребитель пропустил (пришли быстрее кадров)
+    uint64_t skippedSamples() const { return skipped; }
+
+    // Потребитель: последний образец из poll опубликован после подключения
+    // (задержку имеет смысл считать только по таким)
+    bool receivedLive() const { return lastRead > attachCount; }
+
+    // Эпоха производителя и число его образцов в памяти сейчас
+    uint64_t producerEpoch() const { return valid() ? layout->epoch.load(std::memory_order_acquire) : 0; }
+    uint64_t published() const { return valid() ? layout->writeIndex.load(std::memory_order_acquire) : 0; }
+
+    // Потребитель: false - производитель сменился или timeoutSeconds не было образцов;
+    // канал нужно открыть заново
+    bool alive(double timeoutSeconds) const {
+        return valid() && !disconnected && channelClockNs() - lastSampleNs < (int64_t)(timeoutSeconds * 1e9);
+    }
+
+private:
+    static const uint32_t VERSION = 2;
+    static const char* magic() { return "JCHN"; }
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        JointSample sample;
+    };
+
+    struct Layout {
+        char magic[4];
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t reserved;
+        std::atomic<uint64_t> epoch;  // channelClockNs() запуска производителя
+        alignas(64) std::atomic<uint64_t> writeIndex;
+        alignas(64) Slot slots[CAPACITY];
+    };
+
+    // Копия слота index под seqlock; false - слот переписывается или уже другого круга
+    bool readSlot(uint64_t index, JointSample& out) const {
+        const Slot& slot = layout->slots[index % CAPACITY];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2)
+            return false;
+        std::memcpy(&out, &slot.sample, sizeof(JointSample));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    bool headerValid() const {
+        return std::memcmp(layout->magic, magic(), 4) == 0 && layout->version == VERSION;
+    }
+
+    SharedMemory memory;
+    Layout* layout = nullptr;
+    uint64_t epoch = 0;
+    uint64_t lastRead = 0;
+    uint64_t attachCount = 0;  // writeIndex при подключении
+    uint64_t skipped = 0;
+    int64_t lastSampleNs = 0;
+    bool disconnected = false;
+};
+
+// Заменитель контроллера: выдаёт демонстрационные позы дерева с частотой rate Гц,
+// пока running (или seconds секунд, если > 0)
+inline void runJointProducer(JointChannel& channel, const KinematicTree& tree, double rate, double seconds,
+    const std::atomic<bool>& running) {
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    const auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    while (running) {
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0.0 && t >= seconds)
+            break;
+        JointState state = tree.sweepPose((float)t);
+        JointSample sample;
+        sample.jointCount = (uint32_t)tree.jointCount();
+        std::memcpy(sample.angles, state.angles, sizeof(sample.angles));
+        sample.timestampNs = channelClockNs();
+        channel.publish(sample);
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+#endif // JOINT_CHANNEL_H
@@ -0,0 +1,319 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <cstddef>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <glm.hpp>
+#include <matrix_transform.hpp>
+
+#include "Model.h"
+#include "RigidTransform.h"
+
+const int MAX_JOINTS = 8;
+
+// Углы суставов в градусах, одна запись на манипулятор (индексы - как в KinematicTree::joints)
+struct JointState {
+    float angles[MAX_JOINTS] = {};
+};
+
+// Прежняя цепочка на полных mat4 (три матрицы и два произведения на сустав).
+// В кинематике не используется, оставлена как эталон для --bench-fk
+inline glm::mat4 rotAroundPoint(float rad, const glm::vec3& point, const glm::vec3& axis)
+{
+    auto t1 = glm::translate(glm::mat4(1), -point);
+    auto r = glm::rotate(glm::mat4(1), rad, axis);
+    auto t2 = glm::translate(glm::mat4(1), point);
+    return t2 * r * t1;
+}
+
+// Вращательный сустав. Опора и ось заданы в координатах модели в нулевой позе
+struct Joint {
+    std::string name;
+    int parent = -1;                        // родитель всегда стоит раньше в списке
+    glm::vec3 axis = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 pivot = glm::vec3(0.0f);
+    std::string pivotMesh;                  // если задан - опора в центре AABB этого меша
+    float minAngle = -180.0f;
+    float maxAngle = 180.0f;
+};
+
+// Положение и ориентация рабочей точки (инструмента) в координатах модели
+struct Pose {
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 position = glm::vec3(0.0f);
+};
+
+// Кинематическое дерево манипулятора из текстового файла (manipulator.kin):
+//   joint <имя> <родитель|-> <ось x y z> <опора x y z | @меш> <мин> <макс>
+//   part  <меш> <сустав>
+//   tool  <сустав> <точка x y z | @меш>   (по умолчанию - опора последнего сустава)
+// Суставы обходятся сверху вниз: матрица каждого считается один раз,
+// дочерний продолжает мировую матрицу родителя. Меши без part неподвижны.
+class KinematicTree {
+public:
+    std::vector<Joint> joints;
+    std::vector<int> partJoint;  // после bind: сустав каждого меша модели, -1 - неподвижен
+    int toolJoint = -1;          // сустав, которому принадлежит рабочая точка
+    glm::vec3 toolPoint = glm::vec3(0.0f);
+
+    KinematicTree() {}
+
+    // Сколько матриц суставов пересчитано для отрисовки (обнуляется вызывающим раз в кадр).
+    // Считают только computePartTransforms и KinematicPose::update - поток отрисовки;
+    // evaluate/toolPose вызываются и из потоков симуляции, IK и развёртки рабочей зоны
+    static unsigned int& transformsRecomputed() {
+        static unsigned int count = 0;
+        return count;
+    }
+
+    KinematicTree(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "ERROR::KINEMATICS::FILE_NOT_READ: " << path << std::endl;
+            return;
+        }
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            std::istringstream in(line);
+            std::string keyword;
+            if (!(in >> keyword) || keyword[0] == '#')
+                continue;
+            bool parsed = keyword == "joint" ? parseJoint(in) :
+                keyword == "part" ? parsePart(in) :
+                keyword == "tool" ? parseTool(in) : false;
+            if (!parsed)
+                std::cerr << "ERROR::KINEMATICS::PARSE: " << path << ":" << lineNumber << ": " << line << std::endl;
+        }
+    }
+
+    size_t jointCount() const { return joints.size(); }
+
+    int findJoint(const std::string& name) const {
+        for (size_t j = 0; j < joints.size(); j++) {
+            if (joints[j].name == name)
+                return (int)j;
+        }
+        return -1;
+    }
+
+    // Опоры по AABB мешей и части по именам мешей; повторять после Model::Reload
+    void bind(const Model& model) {
+        for (Joint& joint : joints) {
+            if (joint.pivotMesh.empty())
+                continue;
+            auto it = model.nameToAABB.find(joint.pivotMesh);
+            if (it != model.nameToAABB.end() && it->second.init)
+                joint.pivot = it->second.center();
+            else
+                std::cerr << "WARNING::KINEMATICS::PIVOT_MESH_NOT_FOUND: " << joint.pivotMesh << std::endl;
+        }
+        if (!toolMesh.empty()) {
+            auto it = model.nameToAABB.find(toolMesh);
+            if (it != model.nameToAABB.end() && it->second.init)
+                toolPoint = it->second.center();
+            else
+                std::cerr << "WARNING::KINEMATICS::TOOL_MESH_NOT_FOUND: " << toolMesh << std::endl;
+        }
+        if (!toolGiven && !joints.empty()) {
+            toolJoint = (int)joints.size() - 1;
+            toolPoint = joints.back().pivot;
+        }
+
+        partJoint.assign(model.meshNames.size(), -1);
+        for (const PartBinding& part : partNames) {
+            bool found = false;
+            for (size_t m = 0; m < model.meshNames.size(); m++) {
+                if (model.meshNames[m] == part.mesh) {
+                    partJoint[m] = part.joint;
+                    found = true;
+                }
+            }
+            if (!found)
+                std::cerr << "WARNING::KINEMATICS::PART_MESH_NOT_FOUND: " << part.mesh << std::endl;
+        }
+    }
+
+    void clamp(JointState& state) const {
+        for (size_t j = 0; j < joints.size(); j++)
+            state.angles[j] = glm::clamp(state.angles[j], joints[j].minAngle, joints[j].maxAngle);
+    }
+
+    // Демонстрационная поза: каждый сустав качается в своих пределах со своей частотой
+    JointState sweepPose(float phase) const {
+        JointState state;
+        for (size_t j = 0; j < joints.size(); j++) {
+            float mid = 0.5f * (joints[j].minAngle + joints[j].maxAngle);
+            float half = 0.5f * (joints[j].maxAngle - joints[j].minAngle);
+            state.angles[j] = mid + 0.8f * half * std::sin((0.5f + 0.4f * j) * phase);
+        }
+        return state;
+    }
+
+    // world[jointCount()]: мировое преобразование каждого сустава
+    void evaluate(const JointState& state, RigidTransform* world) const {
+        for (size_t j = 0; j < joints.size(); j++)
+            evaluateJoint(j, state, world);
+    }
+
+    // Родитель world[j] должен быть уже посчитан
+    void evaluateJoint(size_t j, const JointState& state, RigidTransform* world) const {
+        const Joint& joint = joints[j];
+        RigidTransform local = RigidTransform::aroundPoint(glm::radians(state.angles[j]), joint.pivot, joint.axis);
+        world[j] = joint.parent < 0 ? local : world[joint.parent] * local;
+    }
+
+    // Рабочая точка для одной позы (пакетный вариант - evaluateFK в BatchFK.h)
+    Pose toolPose(const JointState& state) const {
+        Pose pose;
+        pose.position = toolPoint;
+        if (toolJoint < 0)
+            return pose;
+        RigidTransform world[MAX_JOINTS];
+        evaluate(state, world);
+        pose.rotation = world[toolJoint].rotation;
+        pose.position = world[toolJoint].applyPoint(toolPoint);
+        return pose;
+    }
+
+    // Части получают mat4 (в таком виде они уходят в GPU)
+    void computePartTransforms(const JointState& state, glm::mat4* parts, size_t partCount) const {
+        RigidTransform world[MAX_JOINTS];
+        evaluate(state, world);
+        transformsRecomputed() += (unsigned int)joints.size();
+        glm::mat4 worldMatrix[MAX_JOINTS];
+        for (size_t j = 0; j < joints.size(); j++)
+            worldMatrix[j] = world[j].toMat4();
+        for (size_t p = 0; p < partCount; p++) {
+            int joint = p < partJoint.size() ? partJoint[p] : -1;
+            parts[p] = joint < 0 ? glm::mat4(1.0f) : worldMatrix[joint];
+        }
+    }
+
+private:
+    struct PartBinding {
+        std::string mesh;
+        int joint;
+    };
+    std::vector<PartBinding> partNames;
+    std::string toolMesh;
+    bool toolGiven = false;
+
+    bool parseJoint(std::istringstream& in) {
+        Joint joint;
+        std::string parent, pivot;
+        if (!(in >> joint.name >> parent >> joint.axis.x >> joint.axis.y >> joint.axis.z >> pivot))
+            return false;
+        if (joints.size() >= MAX_JOINTS) {
+            std::cerr << "ERROR::KINEMATICS::TOO_MANY_JOINTS: max " << MAX_JOINTS << std::endl;
+            return false;
+        }
+        if (parent != "-") {
+            joint.parent = findJoint(parent);
+            if (joint.parent < 0)
+                return false;
+        }
+        if (pivot[0] == '@') {
+            joint.pivotMesh = pivot.substr(1);
+        }
+        else {
+            std::istringstream x(pivot);
+            if (!(x >> joint.pivot.x) || !(in >> joint.pivot.y >> joint.pivot.z))
+                return false;
+        }
+        if (!(in >> joint.minAngle >> joint.maxAngle) || glm::length(joint.axis) == 0.0f)
+            return false;
+        joint.axis = glm::normalize(joint.axis);
+        joints.push_back(joint);
+        return true;
+    }
+
+    bool parsePart(std::istringstream& in) {
+        PartBinding part;
+        std::string joint;
+        if (!(in >> part.mesh >> joint))
+            return false;
+        part.joint = findJoint(joint);
+        if (part.joint < 0)
+            return false;
+        partNames.push_back(part);
+        return true;
+    }
+
+    bool parseTool(std::istringstream& in) {
+        std::string joint, point;
+        if (!(in >> joint >> point))
+            return false;
+        toolJoint = findJoint(joint);
+        if (toolJoint < 0)
+            return false;
+        if (point[0] == '@') {
+            toolMesh = point.substr(1);
+        }
+        else {
+            std::istringstream x(point);
+            if (!(x >> toolPoint.x) || !(in >> toolPoint.y >> toolPoint.z))
+                return false;
+        }
+        toolGiven = true;
+        return true;
+    }
+};
+
+// Поза одного манипулятора с пометкой изменившихся суставов: пересчитываются
+// только поддеревья под суставами, чей угол сменился. Кадр без движения
+// не трогает ни одной матрицы.
+class KinematicPose {
+public:
+    // parts[partCount] хранятся у вызывающего между кадрами (например, model.meshTransforms).
+    // true, если хоть одно преобразование частей изменилось
+    bool update(const KinematicTree& tree, const JointState& state, glm::mat4* parts, size_t partCount) {
+        const size_t jointCount = tree.jointCount();
+        const bool all = !valid || partCount != lastPartCount;
+        bool dirty[MAX_JOINTS] = {};
+        bool changed = all;
+        for (size_t j = 0; j < jointCount; j++) {
+            int parent = tree.joints[j].parent;
+            dirty[j] = all || state.angles[j] != last.angles[j] || (parent >= 0 && dirty[parent]);
+            if (dirty[j]) {
+                tree.evaluateJoint(j, state, world);
+                KinematicTree::transformsRecomputed()++;
+                changed = true;
+            }
+        }
+        if (!changed)
+            return false;
+
+        for (size_t p = 0; p < partCount; p++) {
+            int joint = p < tree.partJoint.size() ? tree.partJoint[p] : -1;
+            if (joint < 0) {
+                if (all)
+                    parts[p] = glm::mat4(1.0f);
+            }
+            else if (dirty[joint]) {
+                parts[p] = world[joint].toMat4();
+            }
+        }
+        last = state;
+        lastPartCount = partCount;
+        valid = true;
+        return true;
+    }
+
+    // После смены модели или дерева (Reload, bind)
+    void invalidate() { valid = false; }
+
+private:
+    JointState last;
+    RigidTransform world[MAX_JOINTS];
+    size_t lastPartCount = 0;
+    bool valid = false;
+};
+
+#endif // KINEMATICS_H
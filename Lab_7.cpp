@@ -1,14 +1,36 @@
 #include "Shader.h"
 #include "Model.h"
+#include "UniformBuffer.h"
+#include "Bench.h"
+#include "IndirectRenderer.h"
+#include "InstancedRenderer.h"
+#include "Kinematics.h"
+#include "WorkspaceSampler.h"
+#include "PointCloud.h"
+#include "InverseKinematics.h"
+#include "Simulation.h"
+#include "JointChannel.h"
+#include "TrajectoryLog.h"
+#include "OffscreenTarget.h"
+#include "FrameProfiler.h"
+#include "RenderQueue.h"
+#include "Trace.h"
 #include <GLFW/glfw3.h>
 #include <glm.hpp>
 #include <matrix_transform.hpp>
 #include <type_ptr.hpp>
 #include <iostream>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <future>
+#include <limits>
 
 
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
+const float FAR_PLANE = 100.0f;
 
 glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 5.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
@@ -24,6 +46,29 @@ float fov = 45.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+bool reloadRequested = false;
+bool workspaceToggled = false;
+// P: полосы профилировщика на экране и таблица min/avg/p99 в консоль раз в секунду
+bool profilerVisible = false;
+
+// T: режим "рабочая точка в цель" - стрелки двигают цель по X/Z, PageUp/PageDown по Y,
+// углы суставов находит IK
+bool ikMode = false;
+glm::vec3 ikTarget = glm::vec3(0.0f);
+
+// Воспроизведение журнала (--replay): Пробел - пауза, [ / ] - на 10 с назад/вперёд,
+// - / = - скорость вдвое меньше/больше
+bool replayPaused = false;
+float replaySeekSeconds = 0.0f;  // накопленный переход, обнуляется циклом
+float replaySpeed = 1.0f;
+
+// Рабочая зона: выборок по пространству суставов и размер ячейки (в единицах модели)
+const uint64_t WORKSPACE_SAMPLES = 20000000;
+const float WORKSPACE_VOXEL = 0.025f;
+
+// Столько секунд без образцов от контроллера - канал переоткрывается
+const double JOINT_CHANNEL_TIMEOUT = 2.0;
+
 struct ObjectTransform {
     glm::vec3 position = glm::vec3(0.0f);
     glm::vec3 rotation = glm::vec3(0.0f);
@@ -44,88 +89,161 @@ struct ObjectTransform {
 std::vector<ObjectTransform> objectTransforms;
 
 
-float Cylinder_gradus = 0.0f;
-float plecho_gradus = 0.0f;
-float kyst_gradus = 0.0f;
-float model_speed = 0.05f;
-glm::vec3 plecho_center = glm::vec3();
-glm::vec3 kyst_center = glm::vec3();
+// Суставы манипулятора описаны в manipulator.kin. Углы ведёт поток симуляции
+// (Simulation.h) по командам с клавиатуры; jointState - интерполированная поза кадра
+KinematicTree kinematics;
+JointState jointState;
+SimCommand simCommand;
+
+// Пары клавиш (+/-) для суставов по порядку: 1/2, 3/4, ... 9/0, дальше F1/F2 ...
+const int JOINT_KEYS[MAX_JOINTS][2] = {
+    { GLFW_KEY_1, GLFW_KEY_2 }, { GLFW_KEY_3, GLFW_KEY_4 }, { GLFW_KEY_5, GLFW_KEY_6 },
+    { GLFW_KEY_7, GLFW_KEY_8 }, { GLFW_KEY_9, GLFW_KEY_0 }, { GLFW_KEY_F1, GLFW_KEY_F2 },
+    { GLFW_KEY_F3, GLFW_KEY_F4 }, { GLFW_KEY_F5, GLFW_KEY_F6 }
+};
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
+// Параметры вьюера из командной строки
+struct ViewerOptions {
+    int armCount = 1;
+    bool fleet = false;
+    bool controller = false;
+    std::string recordPath;   // --record: журнал показанных поз
+    std::string replayPath;   // --replay: позы берутся из журнала
+    // --headless: без окна и экрана, кадры в FBO; время идёт по кадрам (1 / fps),
+    // позы - из журнала или демонстрационные, кадры пишутся в outputDir (если задан)
+    bool headless = false;
+    int frames = 300;
+    float fps = 60.0f;
+    int width = SCR_WIDTH;
+    int height = SCR_HEIGHT;
+    std::string outputDir;
+    std::string profileCsv;   // --profile-csv: времена областей кадра построчно
+};
 
-auto rotAroundPoint(float rad, const glm::vec3& point, const glm::vec3& axis)
-{
-
-    auto t1 = glm::translate(glm::mat4(1), -point);
-    auto r = glm::rotate(glm::mat4(1), rad, axis);
-    auto t2 = glm::translate(glm::mat4(1), point);
-    return t2 * r * t1;
-}
-
-glm::mat4 calculateModelMatrix(int index) {
-    glm::mat4 model = glm::mat4(1.0f);
-
-    
+void renderLoop(GLFWwindow* window, const ViewerOptions& options);
+int runProducer(int argc, char** argv);
+int runAnalysis(int argc, char** argv);
+std::vector<PointCloud::Point> buildWorkspaceCloud(KinematicTree tree);
+
+// Манипуляторы кадра как один элемент очереди рисования (RenderQueue.h):
+// drawArms - одинаковые (IndirectRenderer), drawFleet - парк (InstancedRenderer)
+struct ArmsDraw {
+    Model* model;
+    const KinematicTree* kinematics;
+    IndirectRenderer* renderer;
+    InstancedRenderer* fleetRenderer;
+    const std::vector<glm::mat4>* transforms;
+    const std::vector<JointState>* states;
+    bool moved;
+};
 
-    if (index == 0) {
-        model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-        return model;
+void drawArms(DrawItem& item);
+void drawFleet(DrawItem& item);
+void drawPointCloud(DrawItem& item);
+
+int main(int argc, char** argv) {
+    // Lab_7 --produce [Гц] [секунд]: заменитель контроллера, пишет углы в разделяемую память
+    if (argc > 1 && strcmp(argv[1], "--produce") == 0)
+        return runProducer(argc - 2, argv + 2);
+    // Lab_7 --analyze журнал [с] [по]: разбор журнала траектории без окна
+    if (argc > 1 && strcmp(argv[1], "--analyze") == 0)
+        return runAnalysis(argc - 2, argv + 2);
+
+    // Lab_7 --bench-<имя> [аргументы]: замер без интерактивного окна
+    const bool benchmark = argc > 1 && strncmp(argv[1], "--bench-", 8) == 0;
+
+    // Lab_7 --stress N: сетка из N одинаково согнутых манипуляторов (multi-draw indirect)
+    // Lab_7 --fleet N:  N манипуляторов со своими углами суставов (инстансинг)
+    // Lab_7 --record файл: запись поз первого манипулятора в журнал траектории
+    // Lab_7 --replay файл [скорость]: воспроизведение журнала
+    ViewerOptions options;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--stress") == 0 || strcmp(argv[i], "--fleet") == 0) {
+            options.armCount = std::max(1, atoi(argv[i + 1]));
+            options.fleet = strcmp(argv[i], "--fleet") == 0;
+        }
+        else if (strcmp(argv[i], "--record") == 0) {
+            options.recordPath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--profile-csv") == 0) {
+            options.profileCsv = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--replay") == 0) {
+            options.replayPath = argv[i + 1];
+            if (i + 2 < argc && atof(argv[i + 2]) > 0.0)
+                replaySpeed = (float)atof(argv[i + 2]);
+        }
     }
-
-    if (index == 1) { // плечо
-        model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-        model *= rotAroundPoint(glm::radians(plecho_gradus), plecho_center, glm::vec3(1.0f, 0.0f, 0.0f));
-        return model;
+    // Lab_7 --headless [--frames N] [--fps F] [--size W H] [--out каталог]: без дисплея
+    // (платформа GLFW null, контекст OSMesa или EGL - например, Mesa llvmpipe)
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0)
+            options.headless = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.frames = std::max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            options.fps = std::max(1.0f, (float)atof(argv[i + 1]));
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            options.outputDir = argv[i + 1];
+        else if (strcmp(argv[i], "--size") == 0 && i + 2 < argc) {
+            options.width = std::max(1, atoi(argv[i + 1]));
+            options.height = std::max(1, atoi(argv[i + 2]));
+        }
     }
-
-    if (index == 2) { // штука на основании
-        model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-        return model;
+    // Lab_7 --controller: углы первого манипулятора берутся из канала внешнего контроллера
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--controller") == 0)
+            options.controller = true;
     }
 
-    if (index == 3) { // кисть
-        model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-        model *= rotAroundPoint(glm::radians(plecho_gradus), plecho_center, glm::vec3(1.0f, 0.0f, 0.0f));
-        model *= rotAroundPoint(glm::radians(kyst_gradus), kyst_center, glm::vec3(1.0f, 0.0f, 0.0f));
-        return model;
-    }
-    if (index == 4) { // штука на основании
-        model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-        return model;
+    if (options.headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+    // Lab_7 --trace файл.json: временная шкала в формате Chrome Trace Event
+    // (сборка с LAB7_TRACE, см. Trace.h)
+    std::string tracePath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0)
+            tracePath = argv[i + 1];
     }
-    if (index == 5) { // плечо
-        model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-        model *= rotAroundPoint(glm::radians(plecho_gradus), plecho_center, glm::vec3(1.0f, 0.0f, 0.0f));
-        return model;
+#ifdef LAB7_TRACE
+    TRACE_THREAD("main");
+    if (!tracePath.empty())
+        Trace::start();
+#else
+    if (!tracePath.empty())
+        std::cerr << "WARNING::TRACE::DISABLED: build with LAB7_TRACE to record " << tracePath << std::endl;
+#endif
+
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
     }
-    //switch (index)
-    //{
-    //case 1: // штука на основании
-    //    break;
-    //case 3: // кисть
-    //    model *= rotAroundPoint(glm::radians(plecho_gradus), glm::vec3(), glm::vec3(1.0f, 0.0f, 0.0f));
-    //    break;
-    //case 2: // штука на основании
-    //    break;
-    //case 0: // основание
-    //    model *= rotAroundPoint(glm::radians(Cylinder_gradus), glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-    //    break;
-    //}
-
-    return model;
-}
-
-int main() {
-
-    glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "3D Model", NULL, NULL);
+    if (benchmark || options.headless)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = NULL;
+    if (options.headless) {
+        // У платформы null нет своего API контекстов: сначала OSMesa, затем EGL
+        // (surfaceless). Окно здесь - только владелец контекста, рисуется всё в FBO
+        const int contextApis[] = { GLFW_OSMESA_CONTEXT_API, GLFW_EGL_CONTEXT_API };
+        for (int api : contextApis) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+            window = glfwCreateWindow(options.width, options.height, "3D Model", NULL, NULL);
+            if (window != NULL)
+                break;
+        }
+    }
+    else {
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "3D Model", NULL, NULL);
+    }
     if (window == NULL) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -135,7 +253,8 @@ int main() {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (!options.headless)
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
@@ -143,13 +262,129 @@ int main() {
         return -1;
     }
 
-    glEnable(GL_DEPTH_TEST);
+    // GL-объекты (буферы, шейдеры, меши) должны быть уничтожены до glfwTerminate
+    int result = 0;
+    if (benchmark)
+        result = runBenchmark(argv[1], argc - 2, argv + 2);
+    else
+        renderLoop(window, options);
 
-    Shader shader("vertex_sheder.glsl", "fragment_shader.glsl");
-    Model ourModel("manipulator.obj");
+    glfwTerminate();
+#ifdef LAB7_TRACE
+    if (!tracePath.empty()) {
+        Trace::stop();
+        Trace::write(tracePath);
+    }
+#endif
+    return result;
+}
+
+int runProducer(int argc, char** argv) {
+    double rate = argc > 0 ? atof(argv[0]) : 1000.0;
+    double seconds = argc > 1 ? atof(argv[1]) : 0.0;
+    KinematicTree tree("manipulator.kin");
+    JointChannel channel(JOINT_CHANNEL_NAME, true);
+    if (!channel.valid()) {
+        std::cerr << "ERROR::CHANNEL::CREATE_FAILED: " << JOINT_CHANNEL_NAME << std::endl;
+        return -1;
+    }
+    std::cout << "producing " << tree.jointCount() << " joints at " << rate << " Hz into " << JOINT_CHANNEL_NAME << std::endl;
+    std::atomic<bool> running(true);
+    runJointProducer(channel, tree, rate, seconds, running);
+    return 0;
+}
 
-    plecho_center = ourModel.plecho_center;
-    kyst_center = ourModel.kyst_center;
+int runAnalysis(int argc, char** argv) {
+    if (argc < 1) {
+        std::cerr << "usage: Lab_7 --analyze <log> [from s] [to s]" << std::endl;
+        return -1;
+    }
+    TrajectoryReader log(argv[0]);
+    if (!log.valid()) {
+        std::cerr << "ERROR::TRAJECTORY::FILE_NOT_READ: " << argv[0] << std::endl;
+        return -1;
+    }
+    KinematicTree tree("manipulator.kin");
+    const size_t jointCount = std::min<size_t>(tree.jointCount(), log.jointCount());
+    int64_t from = log.startUs() + (argc > 1 ? (int64_t)(atof(argv[1]) * 1e6) : 0);
+    int64_t to = argc > 2 ? log.startUs() + (int64_t)(atof(argv[2]) * 1e6) : log.endUs();
+
+    float minAngle[MAX_JOINTS], maxAngle[MAX_JOINTS], maxSpeed[MAX_JOINTS] = {};
+    uint64_t outOfLimits[MAX_JOINTS] = {};
+    for (size_t j = 0; j < MAX_JOINTS; j++) {
+        minAngle[j] = std::numeric_limits<float>::max();
+        maxAngle[j] = std::numeric_limits<float>::lowest();
+    }
+
+    // Переход к началу окна - по индексу ключевых кадров, дальше последовательное чтение
+    auto start = std::chrono::steady_clock::now();
+    log.seek(from);
+    TrajectorySample sample, previous;
+    uint64_t count = 0;
+    int64_t maxGap = 0;
+    while (log.next(sample) && sample.timeUs <= to) {
+        if (sample.timeUs < from)
+            continue;
+        for (size_t j = 0; j < jointCount; j++) {
+            float angle = sample.state.angles[j];
+            minAngle[j] = std::min(minAngle[j], angle);
+            maxAngle[j] = std::max(maxAngle[j], angle);
+            if (angle < tree.joints[j].minAngle || angle > tree.joints[j].maxAngle)
+                outOfLimits[j]++;
+            if (count > 0 && sample.timeUs > previous.timeUs) {
+                float speed = std::abs(angle - previous.state.angles[j]) * 1e6f / (float)(sample.timeUs - previous.timeUs);
+                maxSpeed[j] = std::max(maxSpeed[j], speed);
+            }
+        }
+        if (count > 0)
+            maxGap = std::max(maxGap, sample.timeUs - previous.timeUs);
+        previous = sample;
+        count++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << argv[0] << ": " << log.sampleCount() << " samples, " << (log.endUs() - log.startUs()) * 1e-6 << " s, "
+        << log.jointCount() << " joints" << std::endl;
+    std::cout << "window " << (from - log.startUs()) * 1e-6 << " .. " << (to - log.startUs()) * 1e-6 << " s: "
+        << count << " samples decoded in " << seconds * 1e3 << " ms (" << count / std::max(seconds, 1e-9) / 1e6
+        << " M samples/s), max gap " << maxGap * 1e-3 << " ms" << std::endl;
+    for (size_t j = 0; j < jointCount && count > 0; j++) {
+        std::cout << "  " << tree.joints[j].name << ": " << minAngle[j] << " .. " << maxAngle[j] << " deg, peak "
+            << maxSpeed[j] << " deg/s";
+        if (outOfLimits[j] > 0)
+            std::cout << ", " << outOfLimits[j] << " samples outside " << tree.joints[j].minAngle << " .. " << tree.joints[j].maxAngle;
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+void renderLoop(GLFWwindow* window, const ViewerOptions& options) {
+    const int armCount = options.armCount;
+    const bool fleet = options.fleet;
+    const bool controller = options.controller;
+    const bool headless = options.headless;
+
+    std::unique_ptr<OffscreenTarget> offscreen;
+    if (headless) {
+        offscreen.reset(new OffscreenTarget(options.width, options.height));
+        if (!offscreen->valid())
+            return;
+        offscreen->bind();
+    }
+    const float aspect = headless ? (float)options.width / (float)options.height : (float)SCR_WIDTH / (float)SCR_HEIGHT;
+    GLCalls::setCapability(GL_DEPTH_TEST, true);
+
+    // Одинаковые манипуляторы - одним glMultiDrawElementsIndirect,
+    // парк с разными углами - по одному инстансному вызову на часть
+    Shader shader(fleet ? "vertex_instanced.glsl" : "vertex_indirect.glsl", "fragment_shader.glsl");
+    IndirectRenderer renderer;
+    InstancedRenderer fleetRenderer;
+    // Вьюеру геометрия на CPU не нужна: после загрузки в GPU она освобождается
+    Model ourModel("manipulator.obj", 0, CpuGeometryPolicy::DropAfterUpload);
+    printLoadStats("manipulator.obj", ourModel.loadStats);
+
+    kinematics = KinematicTree("manipulator.kin");
+    kinematics.bind(ourModel);
 
     objectTransforms.resize(4);
 
@@ -158,53 +393,414 @@ int main() {
     objectTransforms[2].xLimit = { -0.5f, 0.5f };
     objectTransforms[3].xLimit = { -1.0f, 0.5f };
 
-    shader.use();
-    shader.setVec3("light.position", glm::vec3(2.0f, 3.0f, 2.0f));
-    shader.setVec3("light.ambient", glm::vec3(0.1f, 0.1f, 0.1f));
-    shader.setVec3("light.diffuse", glm::vec3(0.8f, 0.8f, 0.8f));
-    shader.setVec3("light.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-    shader.setVec3("material.ambient", glm::vec3(1.0f, 0.1f, 0.1f));
-    shader.setVec3("material.diffuse", glm::vec3(0.2f, 0.4f, 0.8f));
-    shader.setVec3("material.specular", glm::vec3(0.8f, 0.8f, 0.8f));
-    shader.setFloat("material.shininess", 32.0f);
+    // Свет и материал общие для всех программ и не меняются: заливаются один раз
+    UniformBuffer<CameraBlock> cameraUbo(CAMERA_BLOCK_BINDING);
+    UniformBuffer<LightBlock> lightUbo(LIGHT_BLOCK_BINDING);
+    UniformBuffer<MaterialBlock> materialUbo(MATERIAL_BLOCK_BINDING);
+
+    LightBlock light = {};
+    light.position = glm::vec3(2.0f, 3.0f, 2.0f);
+    light.ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    light.diffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+    light.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    lightUbo.update(light);
+
+    MaterialBlock material = {};
+    material.ambient = glm::vec3(1.0f, 0.1f, 0.1f);
+    material.diffuse = glm::vec3(0.2f, 0.4f, 0.8f);
+    material.specular = glm::vec3(0.8f, 0.8f, 0.8f);
+    material.shininess = 32.0f;
+    materialUbo.update(material);
+
+    // Манипуляторы стоят квадратной сеткой, первый - в начале координат
+    std::vector<glm::mat4> armTransforms(armCount);
+    const int gridSide = (int)std::ceil(std::sqrt((float)armCount));
+    for (int i = 0; i < armCount; i++) {
+        armTransforms[i] = glm::translate(glm::mat4(1.0f),
+            glm::vec3(2.0f * (i % gridSide), 0.0f, -2.0f * (i / gridSide)));
+    }
 
-    //printf("%f\t%f\t%f\n", plecho_center.x, plecho_center.y, plecho_center.z);
+    std::vector<JointState> fleetStates(fleet ? armCount : 0);
+    ArmsDraw armsDraw = { &ourModel, &kinematics, &renderer, &fleetRenderer, &armTransforms, &fleetStates, false };
+    RenderQueue drawQueue;
+    // Без движения суставов кадр не пересчитывает матрицы и не переписывает SSBO
+    KinematicPose armPose;
+
+    ArmSimulation simulation;
+    simulation.start(kinematics, jointState);
+
+    // Подключение к каналу контроллера (раз в секунду, пока производитель не появится);
+    // дальше каждый кадр - только чтение разделяемой памяти
+    std::unique_ptr<JointChannel> channel;
+    float channelRetry = 0.0f;
+    JointState controllerState;
+    bool controllerConnected = false;
+    uint64_t lostEpoch = 0;  // состояние канала при последнем PRODUCER_LOST
+    uint64_t lostCount = 0;
+    int64_t displayedSampleNs = 0;  // метка образца, впервые показанного в этом кадре
+    double statsLatency = 0.0;
+    unsigned int statsLatencyFrames = 0;
+
+    // V: облако достижимых рабочей точкой ячеек поверх первого манипулятора
+    Shader pointShader("point_cloud_vertex.glsl", "point_cloud_fragment.glsl");
+    UniformHandle<float> uPointSize = pointShader.uniform<float>("pointSize");
+    PointCloud workspaceCloud;
+    bool showWorkspace = false;
+    std::future<std::vector<PointCloud::Point>> workspaceJob;
+    size_t workspaceJobGeneration = 0;  // ourModel.loadGeneration на момент запуска развёртки
+    PointCloud targetMarker;
+    glm::vec3 markerPosition = glm::vec3(0.0f);
+
+    // Журнал пишется с частотой кадров: покой стоит несколько байт на кадр
+    std::unique_ptr<TrajectoryWriter> recorder;
+    if (!options.recordPath.empty()) {
+        recorder.reset(new TrajectoryWriter(options.recordPath, (uint32_t)kinematics.jointCount()));
+        if (!recorder->valid()) {
+            std::cerr << "ERROR::TRAJECTORY::FILE_NOT_WRITTEN: " << options.recordPath << std::endl;
+            recorder.reset();
+        }
+    }
+    const auto recordStart = std::chrono::steady_clock::now();
+
+    std::unique_ptr<TrajectoryReader> replay;
+    double replayTime = 0.0;  // секунды от начала журнала
+    if (!options.replayPath.empty()) {
+        replay.reset(new TrajectoryReader(options.replayPath));
+        if (!replay->valid()) {
+            std::cerr << "ERROR::TRAJECTORY::FILE_NOT_READ: " << options.replayPath << std::endl;
+            replay.reset();
+        }
+    }
 
-    while (!glfwWindowShouldClose(window)) {
-        float currentFrame = glfwGetTime();
+    float statsTime = 0.0f;
+    unsigned int statsFrames = 0;
+    double statsDrawCpu = 0.0;
+    uint64_t statsSimTicks = 0;
+
+    // Области кадра: CPU и GPU (GL_TIMESTAMP) каждой, без ожидания GPU
+    FrameProfiler profiler;
+    const int P_INPUT = profiler.scope("input");
+    const int P_FK = profiler.scope("fk");
+    const int P_UNIFORMS = profiler.scope("uniforms");
+    const int P_DRAW = profiler.scope("draw");
+    const int P_OVERLAY = profiler.scope("overlay");
+    const int P_PRESENT = profiler.scope(headless ? "readback" : "swap");
+    // Вызовы GL за кадр (GLCalls.h) - в таблицу и CSV профилировщика рядом со временами
+    const int C_DRAWS = profiler.counter("draw calls");
+    const int C_COMMANDS = profiler.counter("draw commands");
+    const int C_BINDS = profiler.counter("binds");
+    const int C_REDUNDANT = profiler.counter("redundant binds");
+    const int C_ELIDED = profiler.counter("elided calls");
+    const int C_UNIFORMS = profiler.counter("uniform calls");
+    const int C_UNIFORM_BYTES = profiler.counter("uniform bytes");
+    const int C_UPLOAD_BYTES = profiler.counter("upload bytes");
+    GLCallStats frameCalls;
+    auto countCalls = [&]() {
+        frameCalls = GLCalls::stats();
+        profiler.count(C_DRAWS, (double)frameCalls.drawCalls);
+        profiler.count(C_COMMANDS, (double)frameCalls.drawCommands);
+        profiler.count(C_BINDS, (double)frameCalls.binds());
+        profiler.count(C_REDUNDANT, (double)frameCalls.redundantBinds());
+        profiler.count(C_ELIDED, (double)frameCalls.elided());
+        profiler.count(C_UNIFORMS, (double)frameCalls.uniformCalls);
+        profiler.count(C_UNIFORM_BYTES, (double)frameCalls.uniformBytes);
+        profiler.count(C_UPLOAD_BYTES, (double)frameCalls.bufferUploadBytes);
+    };
+    if (!options.profileCsv.empty())
+        profiler.openCsv(options.profileCsv);
+    ProfilerOverlay profilerOverlay;
+
+    int frame = 0;
+    double headlessReadback = 0.0;
+    const auto headlessStart = std::chrono::steady_clock::now();
+
+    while (!glfwWindowShouldClose(window) && !(headless && frame == options.frames)) {
+        float currentFrame = headless ? frame / options.fps : (float)glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
+        Shader::uniformLookups() = 0;
+        KinematicTree::transformsRecomputed() = 0;
+        GLCalls::stats() = GLCallStats();
+        profiler.beginFrame();
+
+        profiler.begin(P_INPUT);
         processInput(window);
+        simulation.command(simCommand);
+        jointState = simulation.interpolated();
+        if (controller) {
+            // Производитель перезапущен или молчит - отображение открывается заново,
+            // до этого показывается последняя полученная поза
+            if (channel && channel->valid() && !channel->alive(JOINT_CHANNEL_TIMEOUT)) {
+                // Молчащий сегмент переоткрывается каждые JOINT_CHANNEL_TIMEOUT секунд;
+                // предупреждение - только если с прошлой попытки в нём что-то сменилось
+                if (channel->producerEpoch() != lostEpoch || channel->published() != lostCount) {
+                    std::cerr << "WARNING::JOINT_CHANNEL::PRODUCER_LOST: reconnecting" << std::endl;
+                    lostEpoch = channel->producerEpoch();
+                    lostCount = channel->published();
+                }
+                channel.reset();
+                channelRetry = 0.0f;
+            }
+            if (!channel || !channel->valid()) {
+                channelRetry -= deltaTime;
+                if (channelRetry <= 0.0f) {
+                    channel.reset(new JointChannel(JOINT_CHANNEL_NAME, false, JOINT_CHANNEL_TIMEOUT));
+                    channelRetry = 1.0f;
+                }
+            }
+            JointSample sample;
+            displayedSampleNs = 0;
+            if (channel && channel->poll(sample)) {
+                for (size_t j = 0; j < kinematics.jointCount() && j < sample.jointCount; j++)
+                    controllerState.angles[j] = sample.angles[j];
+                controllerConnected = true;
+                if (channel->receivedLive())
+                    displayedSampleNs = sample.timestampNs;
+            }
+            if (controllerConnected)
+                jointState = controllerState;
+        }
+        if (headless && !replay)
+            jointState = kinematics.sweepPose(currentFrame);
+        if (replay) {
+            const double length = (replay->endUs() - replay->startUs()) * 1e-6;
+            if (!replayPaused)
+                replayTime += deltaTime * replaySpeed;
+            replayTime = glm::clamp(replayTime + replaySeekSeconds, 0.0, length);
+            replaySeekSeconds = 0.0f;
+            replay->sampleAt(replay->startUs() + (int64_t)(replayTime * 1e6), jointState);
+        }
+        if (recorder) {
+            recorder->append(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - recordStart).count(), jointState);
+        }
+        profiler.end(P_INPUT);
 
         glClearColor(0.5f, 0.5f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        shader.use();
-        shader.setVec3("viewPos", cameraPos);
-        glm::mat4 projection = glm::perspective(glm::radians(fov),
-            (float)SCR_WIDTH / (float)SCR_HEIGHT,
-            0.1f, 100.0f);
-        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-        shader.setMat4("projection", projection);
-        shader.setMat4("view", view);
+        CameraBlock camera = {};
+        camera.projection = glm::perspective(glm::radians(fov),
+            aspect,
+            0.1f, FAR_PLANE);
+        camera.view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+        camera.viewPos = cameraPos;
+        profiler.begin(P_UNIFORMS);
+        cameraUbo.update(camera);
+        profiler.end(P_UNIFORMS);
+
+        if (ikMode) {
+            if (targetMarker.size() == 0 || markerPosition != ikTarget) {
+                targetMarker.upload({ { ikTarget, 1.0f } });
+                markerPosition = ikTarget;
+            }
+        }
 
+        auto drawStart = std::chrono::steady_clock::now();
+        // Для парка FK частей считается внутри InstancedRenderer::Draw и попадает в draw
+        bool moved = false;
+        profiler.begin(P_FK);
+        if (fleet) {
+            // Первый манипулятор управляется с клавиатуры, остальные качаются каждый в своей фазе
+            fleetStates[0] = jointState;
+            for (int i = 1; i < armCount; i++)
+                fleetStates[i] = kinematics.sweepPose(currentFrame + 0.37f * i);
+        }
+        else {
+            moved = armPose.update(kinematics, jointState, ourModel.meshTransforms.data(), ourModel.meshTransforms.size());
+        }
+        profiler.end(P_FK);
+        profiler.begin(P_DRAW);
+        if (workspaceToggled) {
+            workspaceToggled = false;
+            showWorkspace = !showWorkspace;
+            if (showWorkspace && workspaceCloud.size() == 0 && !workspaceJob.valid()) {
+                workspaceJob = std::async(std::launch::async, buildWorkspaceCloud, kinematics);
+                workspaceJobGeneration = ourModel.loadGeneration;
+            }
+        }
+        // Развёртка идёт около секунды: кадры не ждут её, облако появится по готовности.
+        // Результат по дереву до перезагрузки (R) выбрасывается; если облако
+        // всё ещё нужно, развёртка запускается заново по новому дереву
+        if (workspaceJob.valid() && workspaceJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            std::vector<PointCloud::Point> points = workspaceJob.get();
+            if (workspaceJobGeneration == ourModel.loadGeneration) {
+                workspaceCloud.upload(points);
+            }
+            else if (showWorkspace) {
+                workspaceJob = std::async(std::launch::async, buildWorkspaceCloud, kinematics);
+                workspaceJobGeneration = ourModel.loadGeneration;
+            }
+        }
+        // Всё рисование кадра - через очередь: сортировка по ключу собирает
+        // элементы одной программы вместе, непрозрачное идёт раньше точек
+        armsDraw.moved = moved;
+        DrawItem arms;
+        arms.shader = &shader;
+        arms.vertexArray = ourModel.arena.VAO;
+        arms.object = &armsDraw;
+        arms.draw = fleet ? drawFleet : drawArms;
+        arms.key = RenderKey::make(RenderPass::Opaque, shader.ID, 0, arms.vertexArray,
+            RenderKey::quantizeDepth(RenderKey::viewDepth(camera.view, glm::vec3(armTransforms[0][3])), FAR_PLANE));
+        drawQueue.submit(arms);
+        if (showWorkspace || ikMode) {
+            // Значение uniform-а хранится в программе до следующей записи
+            pointShader.use();
+            pointShader.set(uPointSize, 40.0f * WORKSPACE_VOXEL * SCR_HEIGHT / fov);
+            DrawItem points;
+            points.shader = &pointShader;
+            points.draw = drawPointCloud;
+            if (showWorkspace) {
+                points.object = &workspaceCloud;
+                points.key = RenderKey::make(RenderPass::Points, pointShader.ID, 0, 0, 0);
+                drawQueue.submit(points);
+            }
+            if (ikMode) {
+                points.object = &targetMarker;
+                points.key = RenderKey::make(RenderPass::Points, pointShader.ID, 0, 0,
+                    RenderKey::quantizeDepth(RenderKey::viewDepth(camera.view, ikTarget), FAR_PLANE));
+                drawQueue.submit(points);
+            }
+        }
+        drawQueue.flush();
+        profiler.end(P_DRAW);
+
+        statsDrawCpu += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - drawStart).count();
+
+        // R: перезагрузка модели; учёт GPU-памяти до и после должен совпасть
+        if (reloadRequested) {
+            TRACE_SCOPE("reload");
+            reloadRequested = false;
+            GpuMemoryStats before = gpuMemory();
+            ourModel.Reload();
+            kinematics.bind(ourModel);
+            armPose.invalidate();
+            simulation.start(kinematics, jointState);
+            statsSimTicks = 0;  // счёт шагов начался заново
+            workspaceCloud.release();
+            showWorkspace = false;
+            printLoadStats("manipulator.obj", ourModel.loadStats);
+            std::cout << "reload: GPU " << before << " -> " << gpuMemory() << std::endl;
+        }
+        //printf("%f\t%f\n", hotizontal_on_start, objectTransforms[3].rotation.x);
 
-        glm::mat4 model_transform = glm::mat4(1.0f);
-        for (size_t i = 0; i < ourModel.meshTransforms.size(); ++i) {
-            ourModel.meshTransforms[i] = calculateModelMatrix(i);
+        // В кадры --headless оверлей не попадает: они сравниваются с эталонными
+        if (profilerVisible && !headless) {
+            ProfileScope scope(profiler, P_OVERLAY);
+            profilerOverlay.Draw(profiler);
         }
-        shader.setMat4("model", model_transform);
 
-        ourModel.Draw(shader);
-        //printf("%f\t%f\n", hotizontal_on_start, objectTransforms[3].rotation.x);
+        if (headless) {
+            // Без --out кадры только рисуются: замер пропускной способности без диска
+            if (!options.outputDir.empty()) {
+                ProfileScope scope(profiler, P_PRESENT);
+                auto readStart = std::chrono::steady_clock::now();
+                char name[32];
+                snprintf(name, sizeof(name), "/frame_%05d.ppm", frame);
+                if (!offscreen->writePPM(options.outputDir + name))
+                    break;
+                headlessReadback += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+            }
+            countCalls();
+            profiler.endFrame();
+            frame++;
+            continue;
+        }
 
+        profiler.begin(P_PRESENT);
         glfwSwapBuffers(window);
+        profiler.end(P_PRESENT);
+        countCalls();
+        if (displayedSampleNs > 0) {
+            statsLatency += (channelClockNs() - displayedSampleNs) * 1e-6;
+            statsLatencyFrames++;
+        }
         glfwPollEvents();
+
+        // Раз в секунду: FPS, CPU-время отрисовки и число строковых поисков uniform-ов
+        statsTime += deltaTime;
+        statsFrames++;
+        if (statsTime >= 1.0f) {
+            std::string title = std::string("3D Model | ") + (fleet ? "fleet" : "arms") + ": " + std::to_string(armCount) +
+                " | FPS: " + std::to_string((int)(statsFrames / statsTime)) +
+                " | draw CPU: " + std::to_string(statsDrawCpu / statsFrames) + " ms" +
+                " | uniform lookups/frame: " + std::to_string(Shader::uniformLookups()) +
+                " | FK transforms/frame: " + std::to_string(KinematicTree::transformsRecomputed()) +
+                " | GL draws/binds (redundant): " + std::to_string(frameCalls.drawCalls) + "/" +
+                std::to_string(frameCalls.binds()) + " (" + std::to_string(frameCalls.redundantBinds()) + ")" +
+                " | GL calls elided: " + std::to_string(frameCalls.elided()) +
+                " | sim: " + std::to_string((int)((simulation.ticks() - statsSimTicks) / statsTime)) + " Hz";
+            if (statsLatencyFrames > 0)
+                title += " | controller latency: " + std::to_string(statsLatency / statsLatencyFrames) + " ms";
+            if (replay) {
+                title += " | replay: " + std::to_string((int)replayTime) + " / " +
+                    std::to_string((int)((replay->endUs() - replay->startUs()) * 1e-6)) + " s x" + std::to_string(replaySpeed) +
+                    (replayPaused ? " (paused)" : "");
+            }
+            if (recorder)
+                title += " | recorded: " + std::to_string(recorder->samples()) + " (" + std::to_string(recorder->bytes() / 1024) + " KB)";
+            glfwSetWindowTitle(window, title.c_str());
+            if (profilerVisible)
+                profiler.print(std::cout);
+            statsTime = 0.0f;
+            statsFrames = 0;
+            statsDrawCpu = 0.0;
+            statsSimTicks = simulation.ticks();
+            statsLatency = 0.0;
+            statsLatencyFrames = 0;
+        }
+        profiler.endFrame();
+    }
+    profiler.finish();
+    if (headless) {
+        glFinish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - headlessStart).count();
+        std::cout << "headless: " << frame << " frames " << options.width << "x" << options.height << " in " << seconds
+            << " s (" << frame / seconds << " FPS), draw CPU " << statsDrawCpu / std::max(frame, 1) << " ms/frame";
+        if (!options.outputDir.empty())
+            std::cout << ", readback+write " << headlessReadback / std::max(frame, 1) << " ms/frame -> " << options.outputDir;
+        std::cout << std::endl;
+        profiler.print(std::cout);
+    }
+    if (recorder) {
+        recorder->close();
+        std::cout << "trajectory: " << recorder->samples() << " samples, " << recorder->bytes() << " bytes -> "
+            << options.recordPath << std::endl;
+    }
+}
+
+// Выполняется в фоновом потоке: дерево передаётся копией, чтобы R (перезагрузка)
+// не менял его под развёрткой; заливка в GPU - в потоке отрисовки
+std::vector<PointCloud::Point> buildWorkspaceCloud(KinematicTree tree) {
+    TRACE_SCOPE("buildWorkspaceCloud");
+    WorkspaceMap map = sampleWorkspace(tree, WORKSPACE_SAMPLES, WORKSPACE_VOXEL);
+    std::cout << "workspace: " << map.samples << " samples on " << map.threads << " threads in "
+        << map.seconds << " s, " << map.centers.size() << " reachable voxels of " << map.voxelSize << std::endl;
+
+    // Вес по логарифму числа попаданий: иначе всё, кроме пары ячеек, одного цвета
+    std::vector<PointCloud::Point> points(map.centers.size());
+    const float scale = 1.0f / std::log(1.0f + (float)map.maxHits);
+    for (size_t i = 0; i < points.size(); i++) {
+        points[i].position = map.centers[i];
+        points[i].weight = std::log(1.0f + (float)map.hits[i]) * scale;
     }
+    return points;
+}
 
-    glfwTerminate();
-    return 0;
+void drawArms(DrawItem& item) {
+    ArmsDraw& arms = *static_cast<ArmsDraw*>(item.object);
+    arms.renderer->Draw(*arms.model, arms.transforms->data(), arms.transforms->size(), arms.moved);
+}
+
+void drawFleet(DrawItem& item) {
+    ArmsDraw& arms = *static_cast<ArmsDraw*>(item.object);
+    arms.fleetRenderer->Draw(*arms.model, *arms.kinematics, arms.transforms->data(), arms.states->data(),
+        arms.transforms->size());
+}
+
+void drawPointCloud(DrawItem& item) {
+    static_cast<PointCloud*>(item.object)->Draw();
 }
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
@@ -231,41 +827,77 @@ void processInput(GLFWwindow* window) {
 
     float moveSpeed = 1.5f * deltaTime;
 
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
-        Cylinder_gradus += model_speed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) {
-        Cylinder_gradus -= model_speed;
-    }
-
-    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) {
-        plecho_gradus += model_speed;
+    static bool reloadKeyDown = false;
+    bool reloadKey = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+    if (reloadKey && !reloadKeyDown)
+        reloadRequested = true;
+    reloadKeyDown = reloadKey;
+
+    static bool ikKeyDown = false;
+    bool ikKey = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+    if (ikKey && !ikKeyDown) {
+        ikMode = !ikMode;
+        ikTarget = kinematics.toolPose(jointState).position;
     }
-    if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) {
-        plecho_gradus -= model_speed;
+    ikKeyDown = ikKey;
+    if (ikMode) {
+        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+            ikTarget.x -= moveSpeed;
+        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+            ikTarget.x += moveSpeed;
+        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+            ikTarget.z -= moveSpeed;
+        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+            ikTarget.z += moveSpeed;
+        if (glfwGetKey(window, GLFW_KEY_PAGE_UP) == GLFW_PRESS)
+            ikTarget.y += moveSpeed;
+        if (glfwGetKey(window, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS)
+            ikTarget.y -= moveSpeed;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS) {
-        kyst_gradus += model_speed;
+    static bool profilerKeyDown = false;
+    bool profilerKey = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+    if (profilerKey && !profilerKeyDown)
+        profilerVisible = !profilerVisible;
+    profilerKeyDown = profilerKey;
+
+    static bool workspaceKeyDown = false;
+    bool workspaceKey = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+    if (workspaceKey && !workspaceKeyDown)
+        workspaceToggled = true;
+    workspaceKeyDown = workspaceKey;
+
+    static bool pauseKeyDown = false, backKeyDown = false, forwardKeyDown = false, slowerKeyDown = false, fasterKeyDown = false;
+    bool pauseKey = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+    bool backKey = glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS;
+    bool forwardKey = glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS;
+    bool slowerKey = glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_PRESS;
+    bool fasterKey = glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_PRESS;
+    if (pauseKey && !pauseKeyDown)
+        replayPaused = !replayPaused;
+    if (backKey && !backKeyDown)
+        replaySeekSeconds -= 10.0f;
+    if (forwardKey && !forwardKeyDown)
+        replaySeekSeconds += 10.0f;
+    if (slowerKey && !slowerKeyDown)
+        replaySpeed = std::max(replaySpeed * 0.5f, 1.0f / 64.0f);
+    if (fasterKey && !fasterKeyDown)
+        replaySpeed = std::min(replaySpeed * 2.0f, 1024.0f);
+    pauseKeyDown = pauseKey;
+    backKeyDown = backKey;
+    forwardKeyDown = forwardKey;
+    slowerKeyDown = slowerKey;
+    fasterKeyDown = fasterKey;
+
+    for (size_t j = 0; j < kinematics.jointCount(); j++) {
+        simCommand.jointDirection[j] = 0.0f;
+        if (glfwGetKey(window, JOINT_KEYS[j][0]) == GLFW_PRESS)
+            simCommand.jointDirection[j] += 1.0f;
+        if (glfwGetKey(window, JOINT_KEYS[j][1]) == GLFW_PRESS)
+            simCommand.jointDirection[j] -= 1.0f;
     }
-    if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS) {
-        kyst_gradus -= model_speed;
-    }
-
-
-    float Cylinder_gradus_ogr = 150.0f;
-    if (Cylinder_gradus > Cylinder_gradus_ogr) Cylinder_gradus = Cylinder_gradus_ogr;
-    if (Cylinder_gradus < -Cylinder_gradus_ogr) Cylinder_gradus = -Cylinder_gradus_ogr;
-
-    float plecho_gradus_ogr_up = 60.0f;
-    float plecho_gradus_ogr_down = -25.0f;
-    if (plecho_gradus > plecho_gradus_ogr_up) plecho_gradus = plecho_gradus_ogr_up;
-    if (plecho_gradus < plecho_gradus_ogr_down) plecho_gradus = plecho_gradus_ogr_down;
-
-    float kyst_gradus_ogr_up = 75.0f;
-    float kyst_gradus_ogr_down = -30.0f;
-    if (kyst_gradus > kyst_gradus_ogr_up) kyst_gradus = kyst_gradus_ogr_up;
-    if (kyst_gradus < kyst_gradus_ogr_down) kyst_gradus = kyst_gradus_ogr_down;
+    simCommand.ikMode = ikMode;
+    simCommand.ikTarget = ikTarget;
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
@@ -0,0 +1,85 @@
+#ifndef LOAD_STATS_H
+#define LOAD_STATS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Сколько байт геометрии прошло через CPU-копии и сколько ушло в GL при загрузке модели
+struct LoadStats {
+    bool fromCache = false;
+    uint64_t bytesCopied = 0;
+    uint64_t bytesUploaded = 0;
+    uint64_t residentBefore = 0;
+    uint64_t residentAfter = 0;
+    uint64_t peakResident = 0;
+    double seconds = 0.0;
+};
+
+// Счётчики текущей загрузки: Mesh и Model добавляют в них по месту копирования
+inline LoadStats& currentLoadStats() {
+    static LoadStats stats;
+    return stats;
+}
+
+inline uint64_t residentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#else
+    unsigned long pages = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL)
+        return 0;
+    if (fscanf(statm, "%lu %lu", &pages, &resident) != 2)
+        resident = 0;
+    fclose(statm);
+    return (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+inline uint64_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (uint64_t)usage.ru_maxrss;
+#else
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+inline void printLoadStats(const std::string& name, const LoadStats& stats) {
+    const double mb = 1024.0 * 1024.0;
+    std::cout << "model load '" << name << "' (" << (stats.fromCache ? "cache" : "assimp") << "): "
+        << stats.seconds * 1000.0 << " ms, copied " << stats.bytesCopied / mb << " MB on CPU, "
+        << "uploaded " << stats.bytesUploaded / mb << " MB, RSS " << stats.residentBefore / mb
+        << " -> " << stats.residentAfter / mb << " MB, peak RSS " << stats.peakResident / mb << " MB" << std::endl;
+}
+
+#endif // LOAD_STATS_H
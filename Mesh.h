@@ -2,59 +2,286 @@
 #define MESH_H
 
 #include <vector>
+#include <utility>
+#include <cstdint>
+#include <cmath>
 #include <glm.hpp>
 #include "Shader.h"
+#include "LoadStats.h"
+#include "GpuMemory.h"
+#include "GLCalls.h"
 
 struct Vertex {
     glm::vec3 Position;
     glm::vec3 Normal;
 };
 
-class Mesh {
+//      CPU    GPU
+enum class CpuGeometryPolicy {
+    KeepCpuCopy,      //   (  /  )
+    DropAfterUpload,  //  GPU
+    KeepCompressed    //  : ~10     24
+};
+
+//  CPU-:  - 16     AABB ,
+//  -   2x16 ,  16 ,  
+class CompressedGeometry {
 public:
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    unsigned int VAO;
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(0.0f);
+    std::vector<uint16_t> positions; // x, y, z
+    std::vector<int16_t> normals;    // u, v
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+
+    CompressedGeometry() {}
+
+    CompressedGeometry(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount) {
+        glm::vec3 lo(0.0f), hi(0.0f);
+        if (vertexCount > 0) {
+            lo = hi = vertices[0].Position;
+        }
+        for (size_t i = 1; i < vertexCount; i++) {
+            lo = glm::min(lo, vertices[i].Position);
+            hi = glm::max(hi, vertices[i].Position);
+        }
+        origin = lo;
+        scale = (hi - lo) / 65535.0f;
 
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
-        : vertices(vertices), indices(indices) {
-        setupMesh();
+        positions.resize(vertexCount * 3);
+        normals.resize(vertexCount * 2);
+        for (size_t i = 0; i < vertexCount; i++) {
+            for (int c = 0; c < 3; c++) {
+                float t = scale[c] > 0.0f ? (vertices[i].Position[c] - origin[c]) / scale[c] : 0.0f;
+                positions[i * 3 + c] = (uint16_t)std::lround(glm::clamp(t, 0.0f, 65535.0f));
+            }
+            glm::vec2 oct = encodeOctahedral(vertices[i].Normal);
+            normals[i * 2 + 0] = (int16_t)std::lround(oct.x * 32767.0f);
+            normals[i * 2 + 1] = (int16_t)std::lround(oct.y * 32767.0f);
+        }
+
+        if (vertexCount <= 65536) {
+            indices16.assign(indices, indices + indexCount);
+        }
+        else {
+            indices32.assign(indices, indices + indexCount);
+        }
     }
 
-    void Draw(Shader& shader) {
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    size_t vertexCount() const { return positions.size() / 3; }
+    size_t indexCount() const { return indices16.empty() ? indices32.size() : indices16.size(); }
+
+    glm::vec3 position(size_t i) const {
+        return origin + scale * glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+    }
+
+    glm::vec3 normal(size_t i) const {
+        return decodeOctahedral(glm::vec2(normals[i * 2], normals[i * 2 + 1]) / 32767.0f);
+    }
+
+    unsigned int index(size_t i) const {
+        return indices16.empty() ? indices32[i] : indices16[i];
+    }
+
+    size_t bytes() const {
+        return positions.capacity() * sizeof(uint16_t) + normals.capacity() * sizeof(int16_t) +
+            indices16.capacity() * sizeof(uint16_t) + indices32.capacity() * sizeof(uint32_t);
     }
 
 private:
-    unsigned int VBO, EBO;
+    static glm::vec2 encodeOctahedral(const glm::vec3& n) {
+        float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (l1 == 0.0f)
+            return glm::vec2(0.0f);
+        glm::vec2 p = glm::vec2(n.x, n.y) / l1;
+        if (n.z < 0.0f) {
+            p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) *
+                glm::vec2(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return p;
+    }
+
+    static glm::vec3 decodeOctahedral(const glm::vec2& p) {
+        glm::vec3 n(p.x, p.y, 1.0f - std::abs(p.x) - std::abs(p.y));
+        if (n.z < 0.0f) {
+            glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) *
+                glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+            n.x = folded.x;
+            n.y = folded.y;
+        }
+        return glm::normalize(n);
+    }
+};
+
+//  VAO/VBO/EBO    :  -   
+// (baseVertex/firstIndex),        VAO
+class GeometryArena {
+public:
+    unsigned int VAO = 0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+
+    GeometryArena() {}
+
+    ~GeometryArena() {
+        release();
+    }
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    GeometryArena(GeometryArena&& other) noexcept {
+        steal(other);
+    }
 
-    void setupMesh() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+    GeometryArena& operator=(GeometryArena&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    // vertexData/indexData == nullptr -     upload*()
+    void create(const Vertex* vertexData, size_t vertices, const unsigned int* indexData, size_t indices) {
+        release();
+        if (vertices == 0 || indices == 0)
+            return;
+        vertexCount = vertices;
+        indexCount = indices;
+        const int64_t vertexBytes = vertexCount * sizeof(Vertex);
+        const int64_t indexBytes = indexCount * sizeof(unsigned int);
+        const GLbitfield flags = (vertexData == nullptr || indexData == nullptr) ? GL_DYNAMIC_STORAGE_BIT : 0;
 
-        glBindVertexArray(VAO);
+        //        
+        glCreateBuffers(1, &VBO);
+        glNamedBufferStorage(VBO, vertexBytes, vertexData, flags);
+        trackBufferCreated(vertexBytes);
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
-            &vertices[0], GL_STATIC_DRAW);
+        glCreateBuffers(1, &EBO);
+        glNamedBufferStorage(EBO, indexBytes, indexData, flags);
+        trackBufferCreated(indexBytes);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-            &indices[0], GL_STATIC_DRAW);
+        if (vertexData != nullptr && indexData != nullptr)
+            currentLoadStats().bytesUploaded += vertexBytes + indexBytes;
+
+        glCreateVertexArrays(1, &VAO);
+        gpuMemory().vertexArrays++;
+        glVertexArrayVertexBuffer(VAO, 0, VBO, 0, sizeof(Vertex));
+        glVertexArrayElementBuffer(VAO, EBO);
 
         //  
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexArrayAttrib(VAO, 0);
+        glVertexArrayAttribFormat(VAO, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Position));
+        glVertexArrayAttribBinding(VAO, 0, 0);
 
         // 
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-            (void*)offsetof(Vertex, Normal));
+        glEnableVertexArrayAttrib(VAO, 1);
+        glVertexArrayAttribFormat(VAO, 1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, Normal));
+        glVertexArrayAttribBinding(VAO, 1, 0);
+    }
+
+    void upload(size_t firstVertex, const std::vector<Vertex>& vertices,
+        size_t firstIndex, const std::vector<unsigned int>& indices) {
+        GLCalls::namedBufferSubData(VBO, firstVertex * sizeof(Vertex), vertices.size() * sizeof(Vertex), vertices.data());
+        GLCalls::namedBufferSubData(EBO, firstIndex * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+        currentLoadStats().bytesUploaded += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int);
+    }
+
+    void release() {
+        if (VAO == 0)
+            return;
+        GLCalls::deleteVertexArray(VAO);
+        GLCalls::deleteBuffer(VBO);
+        GLCalls::deleteBuffer(EBO);
+        trackBufferDeleted(vertexCount * sizeof(Vertex));
+        trackBufferDeleted(indexCount * sizeof(unsigned int));
+        gpuMemory().vertexArrays--;
+        VAO = VBO = EBO = 0;
+        vertexCount = indexCount = 0;
+    }
+
+private:
+    unsigned int VBO = 0, EBO = 0;
+
+    void steal(GeometryArena& other) {
+        VAO = other.VAO;
+        VBO = other.VBO;
+        EBO = other.EBO;
+        vertexCount = other.vertexCount;
+        indexCount = other.indexCount;
+        other.VAO = other.VBO = other.EBO = 0;
+        other.vertexCount = other.indexCount = 0;
+    }
+};
+
+//   GeometryArena   ( ) CPU- .
+//  :     .
+class Mesh {
+public:
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    CompressedGeometry compressed; //   CpuGeometryPolicy::KeepCompressed
+
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    unsigned int baseVertex = 0;  //    VBO
+    unsigned int firstIndex = 0;  //    EBO
+
+    Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices)
+        : vertices(std::move(vertices)), indices(std::move(indices)),
+        vertexCount((unsigned int)this->vertices.size()), indexCount((unsigned int)this->indices.size()) {}
+
+    //     GPU (,    )
+    Mesh(size_t vertexCount, size_t indexCount)
+        : vertexCount((unsigned int)vertexCount), indexCount((unsigned int)indexCount) {}
 
-        glBindVertexArray(0);
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&&) = default;
+    Mesh& operator=(Mesh&&) = default;
+
+    //   CPU   . source* -   ,  
+    //   (   );   -  .
+    void applyCpuPolicy(CpuGeometryPolicy policy,
+        const Vertex* sourceVertices = nullptr, size_t sourceVertexCount = 0,
+        const unsigned int* sourceIndices = nullptr, size_t sourceIndexCount = 0) {
+        if (sourceVertices == nullptr) {
+            sourceVertices = vertices.data();
+            sourceVertexCount = vertices.size();
+            sourceIndices = indices.data();
+            sourceIndexCount = indices.size();
+        }
+
+        switch (policy) {
+        case CpuGeometryPolicy::KeepCpuCopy:
+            if (sourceVertices != vertices.data()) {
+                vertices.assign(sourceVertices, sourceVertices + sourceVertexCount);
+                indices.assign(sourceIndices, sourceIndices + sourceIndexCount);
+                currentLoadStats().bytesCopied += sourceVertexCount * sizeof(Vertex) + sourceIndexCount * sizeof(unsigned int);
+            }
+            compressed = CompressedGeometry();
+            return;
+        case CpuGeometryPolicy::KeepCompressed:
+            compressed = CompressedGeometry(sourceVertices, sourceVertexCount, sourceIndices, sourceIndexCount);
+            break;
+        case CpuGeometryPolicy::DropAfterUpload:
+            compressed = CompressedGeometry();
+            break;
+        }
+        // swap      ,    clear()
+        std::vector<Vertex>().swap(vertices);
+        std::vector<unsigned int>().swap(indices);
+    }
+
+    size_t cpuBytes() const {
+        return vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int) + compressed.bytes();
+    }
+
+    // VAO      (Model::Draw)
+    void Draw(Shader& shader) {
+        GLCalls::drawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+            (void*)(firstIndex * sizeof(unsigned int)), baseVertex);
     }
 };
 
@@ -0,0 +1,206 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glm.hpp>
+
+#include "Mesh.h"
+#include "MappedFile.h"
+
+// Двоичный кэш геометрии рядом с исходной моделью (<модель>.meshcache).
+// Раскладка: FileHeader, MeshRecord[meshCount], имена, затем все Vertex мешей подряд
+// и все индексы мешей подряд (оба блока выровнены на 16 байт). Блоки целиком
+// отдаются в общий VBO/EBO модели прямо из отображения файла.
+namespace MeshCache {
+
+const uint32_t MAGIC = 0x4843534D; // "MSCH"
+const uint32_t VERSION = 2;
+const uint64_t PAYLOAD_ALIGNMENT = 16;
+
+// Ключ кэша: размер и время изменения исходного файла
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint32_t vertexStride; // смена формата Vertex тоже инвалидирует кэш
+    uint32_t meshCount;
+};
+
+struct MeshRecord {
+    uint64_t nameOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t nameLength;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    float aabbMin[3];
+    float aabbMax[3];
+    uint32_t pad;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout is part of the file format");
+static_assert(sizeof(MeshRecord) == 64, "MeshRecord layout is part of the file format");
+
+// Меш в кэше: при чтении указатели смотрят в отображённый файл
+struct MeshView {
+    std::string name;
+    const Vertex* vertices;
+    uint32_t vertexCount;
+    const unsigned int* indices;
+    uint32_t indexCount;
+    glm::vec3 aabbMin;
+    glm::vec3 aabbMax;
+};
+
+inline std::string cachePathFor(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+inline bool sourceStamp(const std::string& path, SourceStamp& stamp) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    stamp.size = (uint64_t)st.st_size;
+    stamp.mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+inline uint64_t alignUp(uint64_t value) {
+    return (value + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1);
+}
+
+// false, если кэш устарел, от другой версии или повреждён
+inline bool read(const MappedFile& file, const SourceStamp& stamp, std::vector<MeshView>& meshes) {
+    if (!file.valid() || file.size() < sizeof(FileHeader))
+        return false;
+
+    const unsigned char* base = file.data();
+    FileHeader header;
+    memcpy(&header, base, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION || header.vertexStride != sizeof(Vertex) ||
+        header.sourceSize != stamp.size || header.sourceMtime != stamp.mtime)
+        return false;
+
+    const uint64_t fileSize = file.size();
+    if (sizeof(FileHeader) + (uint64_t)header.meshCount * sizeof(MeshRecord) > fileSize)
+        return false;
+
+    const MeshRecord* records = reinterpret_cast<const MeshRecord*>(base + sizeof(FileHeader));
+    meshes.clear();
+    meshes.reserve(header.meshCount);
+    uint64_t nextVertex = header.meshCount ? records[0].vertexOffset : 0;
+    uint64_t nextIndex = header.meshCount ? records[0].indexOffset : 0;
+    if (nextVertex % PAYLOAD_ALIGNMENT || nextIndex % PAYLOAD_ALIGNMENT)
+        return false;
+    for (uint32_t i = 0; i < header.meshCount; i++) {
+        const MeshRecord& r = records[i];
+        const uint64_t vertexBytes = (uint64_t)r.vertexCount * sizeof(Vertex);
+        const uint64_t indexBytes = (uint64_t)r.indexCount * sizeof(unsigned int);
+        // Блоки вершин и индексов должны идти подряд - иначе одной заливкой их не взять
+        if (r.nameOffset + r.nameLength > fileSize ||
+            r.vertexOffset != nextVertex || r.vertexOffset + vertexBytes > fileSize ||
+            r.indexOffset != nextIndex || r.indexOffset + indexBytes > fileSize)
+            return false;
+        nextVertex += vertexBytes;
+        nextIndex += indexBytes;
+
+        MeshView view;
+        view.name.assign(reinterpret_cast<const char*>(base + r.nameOffset), r.nameLength);
+        view.vertices = reinterpret_cast<const Vertex*>(base + r.vertexOffset);
+        view.vertexCount = r.vertexCount;
+        view.indices = reinterpret_cast<const unsigned int*>(base + r.indexOffset);
+        view.indexCount = r.indexCount;
+        view.aabbMin = glm::vec3(r.aabbMin[0], r.aabbMin[1], r.aabbMin[2]);
+        view.aabbMax = glm::vec3(r.aabbMax[0], r.aabbMax[1], r.aabbMax[2]);
+        meshes.push_back(view);
+    }
+    return true;
+}
+
+inline bool write(const std::string& path, const SourceStamp& stamp, const std::vector<MeshView>& meshes) {
+    FileHeader header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.sourceSize = stamp.size;
+    header.sourceMtime = stamp.mtime;
+    header.vertexStride = sizeof(Vertex);
+    header.meshCount = (uint32_t)meshes.size();
+
+    std::vector<MeshRecord> records(meshes.size());
+    uint64_t offset = sizeof(FileHeader) + records.size() * sizeof(MeshRecord);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        records[i].nameOffset = offset;
+        records[i].nameLength = (uint32_t)meshes[i].name.size();
+        offset += meshes[i].name.size();
+    }
+    offset = alignUp(offset);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        records[i].vertexOffset = offset;
+        records[i].vertexCount = meshes[i].vertexCount;
+        offset += (uint64_t)meshes[i].vertexCount * sizeof(Vertex);
+    }
+    offset = alignUp(offset);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        records[i].indexOffset = offset;
+        records[i].indexCount = meshes[i].indexCount;
+        offset += (uint64_t)meshes[i].indexCount * sizeof(unsigned int);
+    }
+    for (size_t i = 0; i < meshes.size(); i++) {
+        memcpy(records[i].aabbMin, &meshes[i].aabbMin[0], sizeof(records[i].aabbMin));
+        memcpy(records[i].aabbMax, &meshes[i].aabbMax[0], sizeof(records[i].aabbMax));
+    }
+
+    // Пишем во временный файл и переименовываем: читатель не увидит недописанный кэш
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        uint64_t written = 0;
+        auto put = [&](const void* data, uint64_t size) {
+            out.write(static_cast<const char*>(data), (std::streamsize)size);
+            written += size;
+        };
+        auto pad = [&]() {
+            static const char zeros[PAYLOAD_ALIGNMENT] = {};
+            put(zeros, alignUp(written) - written);
+        };
+
+        put(&header, sizeof(header));
+        put(records.data(), records.size() * sizeof(MeshRecord));
+        for (size_t i = 0; i < meshes.size(); i++)
+            put(meshes[i].name.data(), meshes[i].name.size());
+        pad();
+        for (size_t i = 0; i < meshes.size(); i++)
+            put(meshes[i].vertices, (uint64_t)meshes[i].vertexCount * sizeof(Vertex));
+        pad();
+        for (size_t i = 0; i < meshes.size(); i++) {
+            put(meshes[i].indices, (uint64_t)meshes[i].indexCount * sizeof(unsigned int));
+        }
+        if (!out) {
+            out.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+} // namespace MeshCache
+
+#endif // MESH_CACHE_H
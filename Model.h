@@ -6,6 +6,7 @@
 #include <iostream>
 #include <limits>
 #include <unordered_map>
+#include <chrono>
 
 //  GLM-
 #include <glm.hpp>
@@ -15,9 +16,12 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/Subdivision.h>
 
 #include "Mesh.h"
+#include "MeshCache.h"
 #include "Shader.h"
+#include "Trace.h"
 
 struct AABB {
     glm::vec3 min;
@@ -42,46 +46,80 @@ struct AABB {
     }
 };
 
+//       ,       .
+//    ( + )    3x3 .
+inline glm::mat3 computeNormalMatrix(const glm::mat4& model) {
+    glm::mat3 m(model);
+    const float eps = 1e-4f;
+    bool rigid = true;
+    for (int i = 0; i < 3 && rigid; i++) {
+        for (int j = i; j < 3 && rigid; j++) {
+            float d = glm::dot(m[i], m[j]);
+            rigid = std::abs(d - (i == j ? 1.0f : 0.0f)) < eps;
+        }
+    }
+    return rigid ? m : glm::transpose(glm::inverse(m));
+}
+
 class Model {
 public:
-    //    (  AABB)
-    glm::vec3 plecho_center = glm::vec3(0.0f);
-    glm::vec3 kyst_center = glm::vec3(0.0f);
-
     std::vector<Mesh> meshes;
+    GeometryArena arena;  //  VAO/VBO/EBO  
     std::vector<glm::mat4> meshTransforms;
     std::string directory;
 
     // :    -> /
     std::vector<std::string> meshNames;  //    meshes
+    std::vector<AABB> meshBounds;        // AABB  ,   
     std::unordered_map<std::string, AABB> nameToAABB;
 
-    Model(std::string const& path) {
-        loadModel(path);
-        meshTransforms.resize(meshes.size(), glm::mat4(1.0f));
+    //       
+    LoadStats loadStats;
+    //    :     ,   
+    size_t loadGeneration = 0;
 
-        // ===       ===
-        //    manipulatorlab3.obj:
-        // plecho_center <- "Cube.001" ( )
-        // kyst_center   <- "Cube"     ()
-        auto itP = nameToAABB.find("Cube.002");
-        if (itP != nameToAABB.end() && itP->second.init) {
-            plecho_center = itP->second.center();
-        }
-        auto itK = nameToAABB.find("Cube.003");
-        if (itK != nameToAABB.end() && itK->second.init) {
-            kyst_center = itK->second.center();
-        }
-        //   fallback-,      .
+    // subdivisionLevels > 0 -  Catmull-Clark (   )
+    // cpuPolicy -         GPU (  /)
+    Model(std::string const& path, unsigned int subdivisionLevels = 0,
+        CpuGeometryPolicy cpuPolicy = CpuGeometryPolicy::KeepCpuCopy)
+        : sourcePath(path), sourceSubdivisionLevels(subdivisionLevels), cpuPolicy(cpuPolicy) {
+        load();
+    }
+
+    //    :  GL-   Mesh
+    void Reload() {
+        meshes.clear();
+        arena.release();
+        meshTransforms.clear();
+        meshNames.clear();
+        meshBounds.clear();
+        nameToAABB.clear();
+        load();
     }
 
     void Draw(Shader& shader) {
+        Draw(shader, shader.uniform<glm::mat4>("model"), shader.uniform<glm::mat3>("normalMatrix"));
+    }
+
+    void Draw(Shader& shader, UniformHandle<glm::mat4> modelLoc, UniformHandle<glm::mat3> normalLoc) {
+        GLCalls::bindVertexArray(arena.VAO);
         for (size_t i = 0; i < meshes.size(); i++) {
-            shader.setMat4("model", meshTransforms[i]);
+            shader.set(modelLoc, meshTransforms[i]);
+            if (normalLoc.valid()) {
+                shader.set(normalLoc, computeNormalMatrix(meshTransforms[i]));
+            }
             meshes[i].Draw(shader);
         }
     }
 
+    // ,     cpuPolicy
+    size_t cpuGeometryBytes() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < meshes.size(); i++)
+            bytes += meshes[i].cpuBytes();
+        return bytes;
+    }
+
     void UpdateTransform(int meshIndex, const glm::mat4& transform) {
         if (meshIndex >= 0 && meshIndex < (int)meshTransforms.size()) {
             meshTransforms[meshIndex] = transform;
@@ -89,29 +127,159 @@ public:
     }
 
 private:
-    void loadModel(std::string const& path) {
-        Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(
-            path,
+    std::string sourcePath;
+    unsigned int sourceSubdivisionLevels;
+    CpuGeometryPolicy cpuPolicy;
+
+    static size_t nextLoadGeneration() {
+        static size_t generation = 0;
+        return ++generation;
+    }
+
+    void load() {
+        LoadStats& stats = currentLoadStats();
+        stats = LoadStats();
+        stats.residentBefore = residentBytes();
+        auto start = std::chrono::steady_clock::now();
+
+        loadModel(sourcePath, sourceSubdivisionLevels);
+        loadGeneration = nextLoadGeneration();
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.residentAfter = residentBytes();
+        stats.peakResident = peakResidentBytes();
+        loadStats = stats;
+        meshTransforms.resize(meshes.size(), glm::mat4(1.0f));
+    }
+
+    void loadModel(std::string const& path, unsigned int subdivisionLevels) {
+        TRACE_SCOPE("Model::loadModel");
+        const unsigned int postProcess =
             aiProcess_Triangulate |
             aiProcess_GenNormals |
-            aiProcess_FlipUVs
+            aiProcess_FlipUVs;
             //  : | aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality
-        );
+
+        //  (     )
+        size_t slashPos = path.find_last_of("/\\");
+        directory = (slashPos == std::string::npos) ? "" : path.substr(0, slashPos);
+
+        // Ҹ :     , Assimp  
+        // (   ,  )
+        MeshCache::SourceStamp stamp;
+        const bool cacheable = subdivisionLevels == 0 && MeshCache::sourceStamp(path, stamp);
+        if (cacheable && loadFromCache(MeshCache::cachePathFor(path), stamp)) {
+            return;
+        }
+
+        Assimp::Importer importer;
+        //     ,   -  
+        const aiScene* scene = importer.ReadFile(path, subdivisionLevels ? 0u : postProcess);
+
+        if (scene && subdivisionLevels && scene->mNumMeshes) {
+            std::vector<aiMesh*> subdivided(scene->mNumMeshes);
+            Assimp::Subdivider* subdivider = Assimp::Subdivider::Create(Assimp::Subdivider::CATMULL_CLARKE);
+            subdivider->Subdivide(scene->mMeshes, scene->mNumMeshes, subdivided.data(), subdivisionLevels, true);
+            delete subdivider;
+            std::copy(subdivided.begin(), subdivided.end(), scene->mMeshes);
+            scene = importer.ApplyPostProcessing(postProcess);
+        }
 
         if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
             std::cerr << "ASSIMP ERROR: " << importer.GetErrorString() << std::endl;
             return;
         }
 
-        //  (     )
-        size_t slashPos = path.find_last_of("/\\");
-        directory = (slashPos == std::string::npos) ? "" : path.substr(0, slashPos);
-
         processNode(scene->mRootNode, scene);
+
+        //          
+        size_t totalVertices = 0, totalIndices = 0;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            meshes[i].baseVertex = (unsigned int)totalVertices;
+            meshes[i].firstIndex = (unsigned int)totalIndices;
+            totalVertices += meshes[i].vertexCount;
+            totalIndices += meshes[i].indexCount;
+        }
+        arena.create(nullptr, totalVertices, nullptr, totalIndices);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            arena.upload(meshes[i].baseVertex, meshes[i].vertices, meshes[i].firstIndex, meshes[i].indices);
+        }
+
+        if (cacheable && !writeCache(MeshCache::cachePathFor(path), stamp)) {
+            std::cerr << "WARNING::MODEL::CACHE_NOT_WRITTEN: " << MeshCache::cachePathFor(path) << std::endl;
+        }
+
+        //         
+        for (size_t i = 0; i < meshes.size(); i++) {
+            meshes[i].applyCpuPolicy(cpuPolicy);
+        }
+    }
+
+    bool loadFromCache(const std::string& cachePath, const MeshCache::SourceStamp& stamp) {
+        MappedFile file(cachePath);
+        std::vector<MeshCache::MeshView> views;
+        if (!MeshCache::read(file, stamp, views)) {
+            return false;
+        }
+        currentLoadStats().fromCache = true;
+
+        size_t totalVertices = 0, totalIndices = 0;
+        for (size_t i = 0; i < views.size(); i++) {
+            const MeshCache::MeshView& view = views[i];
+            meshNames.push_back(view.name);
+            meshes.emplace_back(view.vertexCount, view.indexCount);
+            meshes.back().baseVertex = (unsigned int)totalVertices;
+            meshes.back().firstIndex = (unsigned int)totalIndices;
+            meshes.back().applyCpuPolicy(cpuPolicy, view.vertices, view.vertexCount, view.indices, view.indexCount);
+            totalVertices += view.vertexCount;
+            totalIndices += view.indexCount;
+
+            AABB box;
+            box.min = view.aabbMin;
+            box.max = view.aabbMax;
+            box.init = view.vertexCount > 0;
+            addBounds(view.name, box);
+        }
+
+        //         :      
+        if (!views.empty()) {
+            arena.create(views[0].vertices, totalVertices, views[0].indices, totalIndices);
+        }
+        return true;
+    }
+
+    bool writeCache(const std::string& cachePath, const MeshCache::SourceStamp& stamp) const {
+        std::vector<MeshCache::MeshView> views(meshes.size());
+        for (size_t i = 0; i < meshes.size(); i++) {
+            views[i].name = meshNames[i];
+            views[i].vertices = meshes[i].vertices.data();
+            views[i].vertexCount = (uint32_t)meshes[i].vertices.size();
+            views[i].indices = meshes[i].indices.data();
+            views[i].indexCount = (uint32_t)meshes[i].indices.size();
+            views[i].aabbMin = meshBounds[i].min;
+            views[i].aabbMax = meshBounds[i].max;
+        }
+        return MeshCache::write(cachePath, stamp, views);
+    }
+
+    void addBounds(const std::string& meshName, const AABB& aabbAccum) {
+        meshBounds.push_back(aabbAccum);
+
+        // / AABB  
+        auto& box = nameToAABB[meshName];
+        if (!box.init) {
+            box = aabbAccum;
+        }
+        else {
+            //          AABB
+            box.min = glm::min(box.min, aabbAccum.min);
+            box.max = glm::max(box.max, aabbAccum.max);
+            box.init = true;
+        }
     }
 
     void processNode(aiNode* node, const aiScene* scene) {
+        TRACE_SCOPE("Model::processNode");
         //     
         for (unsigned int m = 0; m < node->mNumMeshes; m++) {
             aiMesh* mesh = scene->mMeshes[node->mMeshes[m]];
@@ -124,24 +292,14 @@ private:
             meshNames.push_back(meshName);
 
             // 1)     Mesh
-            meshes.push_back(processMesh(mesh, scene));
+            processMesh(mesh, scene);
 
             // 2)  AABB     (min/max   )
             AABB aabbAccum; //     
             for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
                 aabbAccum.expand(mesh->mVertices[i]);
             }
-            // / AABB  
-            auto& box = nameToAABB[meshName];
-            if (!box.init) {
-                box = aabbAccum;
-            }
-            else {
-                //          AABB
-                box.min = glm::min(box.min, aabbAccum.min);
-                box.max = glm::max(box.max, aabbAccum.max);
-                box.init = true;
-            }
+            addBounds(meshName, aabbAccum);
         }
 
         //  (   )
@@ -153,7 +311,8 @@ private:
         }
     }
 
-    Mesh processMesh(aiMesh* mesh, const aiScene* /*scene*/) {
+    void processMesh(aiMesh* mesh, const aiScene* /*scene*/) {
+        TRACE_SCOPE("Model::processMesh");
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
         vertices.reserve(mesh->mNumVertices);
@@ -190,7 +349,10 @@ private:
             }
         }
 
-        return Mesh(vertices, indices);
+        //  CPU- -   aiMesh;    
+        currentLoadStats().bytesCopied += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int);
+
+        meshes.emplace_back(std::move(vertices), std::move(indices));
     }
 };
 
@@ -0,0 +1,94 @@
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <GL/glew.h>
+
+// Кадр без окна: FBO с цветом RGBA8 и глубиной 24 бита в renderbuffer-ах.
+// Для пакетных прогонов (Lab_7 --headless), где окна и экрана нет вовсе
+class OffscreenTarget {
+public:
+    OffscreenTarget(int width, int height) : w(width), h(height) {
+        glCreateRenderbuffers(1, &color);
+        glNamedRenderbufferStorage(color, GL_RGBA8, w, h);
+        glCreateRenderbuffers(1, &depth);
+        glNamedRenderbufferStorage(depth, GL_DEPTH_COMPONENT24, w, h);
+
+        glCreateFramebuffers(1, &FBO);
+        glNamedFramebufferRenderbuffer(FBO, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        glNamedFramebufferRenderbuffer(FBO, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        GLenum status = glCheckNamedFramebufferStatus(FBO, GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ERROR::FRAMEBUFFER::INCOMPLETE: 0x" << std::hex << status << std::dec << std::endl;
+            release();
+        }
+    }
+
+    ~OffscreenTarget() {
+        release();
+    }
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    bool valid() const { return FBO != 0; }
+    int width() const { return w; }
+    int height() const { return h; }
+
+    // Дальнейшая отрисовка идёт в кадр; viewport - на весь кадр
+    void bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, w, h);
+    }
+
+    // RGB по строкам сверху вниз (GL отдаёт снизу вверх). Синхронно: ждёт конца отрисовки
+    void read(std::vector<unsigned char>& rgb) const {
+        const size_t row = (size_t)w * 3;
+        rgb.resize(row * h);
+        pixels.resize(rgb.size());
+        glNamedFramebufferReadBuffer(FBO, GL_COLOR_ATTACHMENT0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+        for (int y = 0; y < h; y++)
+            std::copy(pixels.begin() + row * (h - 1 - y), pixels.begin() + row * (h - y), rgb.begin() + row * y);
+    }
+
+    // Двоичный PPM (P6): читается любым просмотрщиком и сравнивается побайтно
+    bool writePPM(const std::string& path) const {
+        read(frame);
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == NULL) {
+            std::cerr << "ERROR::FRAMEBUFFER::FILE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        std::fprintf(file, "P6\n%d %d\n255\n", w, h);
+        bool ok = std::fwrite(frame.data(), 1, frame.size(), file) == frame.size();
+        std::fclose(file);
+        return ok;
+    }
+
+    void release() {
+        if (FBO != 0)
+            glDeleteFramebuffers(1, &FBO);
+        if (color != 0)
+            glDeleteRenderbuffers(1, &color);
+        if (depth != 0)
+            glDeleteRenderbuffers(1, &depth);
+        FBO = color = depth = 0;
+    }
+
+private:
+    int w, h;
+    unsigned int FBO = 0;
+    unsigned int color = 0;
+    unsigned int depth = 0;
+    mutable std::vector<unsigned char> pixels;
+    mutable std::vector<unsigned char> frame;
+};
+
+#endif // OFFSCREEN_TARGET_H
@@ -0,0 +1,84 @@
+#ifndef POINT_CLOUD_H
+#define POINT_CLOUD_H
+
+#include <vector>
+#include <glm.hpp>
+#include <GL/glew.h>
+
+#include "GpuMemory.h"
+#include "GLCalls.h"
+#include "Shader.h"
+
+// Облако точек поверх сцены (например, достижимые ячейки рабочей зоны).
+// Точка - позиция и вес 0..1, цвет по весу задаёт point_cloud_fragment.glsl
+class PointCloud {
+public:
+    struct Point {
+        glm::vec3 position;
+        float weight;
+    };
+
+    PointCloud() {}
+
+    ~PointCloud() {
+        release();
+    }
+
+    PointCloud(const PointCloud&) = delete;
+    PointCloud& operator=(const PointCloud&) = delete;
+
+    void upload(const std::vector<Point>& points) {
+        release();
+        if (points.empty())
+            return;
+        count = points.size();
+        bytes = count * sizeof(Point);
+
+        glCreateBuffers(1, &VBO);
+        glNamedBufferStorage(VBO, bytes, points.data(), 0);
+        trackBufferCreated(bytes);
+
+        glCreateVertexArrays(1, &VAO);
+        gpuMemory().vertexArrays++;
+        glVertexArrayVertexBuffer(VAO, 0, VBO, 0, sizeof(Point));
+        glEnableVertexArrayAttrib(VAO, 0);
+        glVertexArrayAttribFormat(VAO, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Point, position));
+        glVertexArrayAttribBinding(VAO, 0, 0);
+        glEnableVertexArrayAttrib(VAO, 1);
+        glVertexArrayAttribFormat(VAO, 1, 1, GL_FLOAT, GL_FALSE, offsetof(Point, weight));
+        glVertexArrayAttribBinding(VAO, 1, 0);
+    }
+
+    // Шейдер должен быть активен (use), uniform-ы камеры - в CameraBlock
+    void Draw() const {
+        if (VAO == 0)
+            return;
+        // Размер из шейдера действует только на точки, так что режим можно не выключать
+        GLCalls::setCapability(GL_PROGRAM_POINT_SIZE, true);
+        GLCalls::bindVertexArray(VAO);
+        GLCalls::drawArrays(GL_POINTS, 0, (GLsizei)count);
+    }
+
+    size_t size() const { return count; }
+
+    void release() {
+        if (VAO == 0)
+            return;
+        GLCalls::deleteVertexArray(VAO);
+        gpuMemory().vertexArrays--;
+        GLCalls::deleteBuffer(VBO);
+        trackBufferDeleted(bytes);
+        VAO = 0;
+        VBO = 0;
+        count = 0;
+        bytes = 0;
+    }
+
+private:
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+#endif // POINT_CLOUD_H
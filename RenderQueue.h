@@ -0,0 +1,208 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <glm.hpp>
+#include <GL/glew.h>
+
+#include "Model.h"
+#include "Shader.h"
+#include "GLCalls.h"
+
+// Проходы кадра в порядке исполнения
+enum class RenderPass : uint32_t {
+    Opaque = 0,
+    Points = 1,       // облака точек поверх непрозрачной геометрии
+    Transparent = 2,  // сзади вперёд
+    Overlay = 3
+};
+
+// 64-битный ключ сортировки, старшие биты важнее:
+//   непрозрачные  pass:2 | program:12 | material:12 | VAO:14 | depth:24
+//   прозрачные    pass:2 | (max - depth):24 | program:12 | material:12 | VAO:14
+// Внутри одного состояния непрозрачные идут спереди назад (ранний отсев по глубине),
+// прозрачным порядок по глубине важнее смены состояния. Имена GL берутся по маске:
+// совпадение младших битов у разных объектов портит только порядок, не результат -
+// состояние каждый элемент устанавливает сам.
+namespace RenderKey {
+    const uint32_t PROGRAM_BITS = 12;
+    const uint32_t MATERIAL_BITS = 12;
+    const uint32_t VERTEX_ARRAY_BITS = 14;
+    const uint32_t DEPTH_BITS = 24;
+    const uint32_t DEPTH_MAX = (1u << DEPTH_BITS) - 1;
+
+    // Расстояние от камеры вдоль луча зрения (-z в координатах камеры)
+    inline float viewDepth(const glm::mat4& view, const glm::vec3& position) {
+        return -(view * glm::vec4(position, 1.0f)).z;
+    }
+
+    // Глубина в 0..DEPTH_MAX; всё дальше farPlane - одно значение
+    inline uint32_t quantizeDepth(float depth, float farPlane) {
+        float t = glm::clamp(depth / farPlane, 0.0f, 1.0f);
+        return (uint32_t)(t * DEPTH_MAX);
+    }
+
+    inline uint64_t make(RenderPass pass, uint32_t program, uint32_t material, uint32_t vertexArray, uint32_t depth) {
+        const uint64_t p = (uint64_t)pass << 62;
+        const uint64_t prog = program & ((1u << PROGRAM_BITS) - 1);
+        const uint64_t mat = material & ((1u << MATERIAL_BITS) - 1);
+        const uint64_t vao = vertexArray & ((1u << VERTEX_ARRAY_BITS) - 1);
+        const uint64_t d = depth & DEPTH_MAX;
+        if (pass == RenderPass::Transparent)
+            return p | (uint64_t)(DEPTH_MAX - d) << 38 | prog << 26 | mat << 14 | vao;
+        return p | prog << 50 | mat << 38 | vao << 24 | d;
+    }
+}
+
+struct DrawItem;
+typedef void (*DrawFunction)(DrawItem& item);
+
+// Один вызов рисования в очереди. Либо меш модели со своим преобразованием
+// (uniform-ы model / normalMatrix), либо произвольное рисование draw(item)
+// над object (например, IndirectRenderer целиком). Программу и VAO ставит очередь.
+struct DrawItem {
+    uint64_t key = 0;
+    Shader* shader = nullptr;
+    GLuint vertexArray = 0;
+
+    Mesh* mesh = nullptr;
+    glm::mat4 transform = glm::mat4(1.0f);
+    UniformHandle<glm::mat4> modelLoc;
+    UniformHandle<glm::mat3> normalLoc;
+
+    DrawFunction draw = nullptr;
+    void* object = nullptr;
+};
+
+// Очередь рисования: элементы копятся за кадр, сортируются поразрядно по ключу
+// (LSD, 8 проходов по байту; проход, где у всех ключей один и тот же байт,
+// пропускается - обычно это старшие байты pass/program) и исполняются подряд.
+// Uniform-ы, общие для всех элементов программы, задаются до flush(): значения
+// uniform-ов хранятся в объекте программы и переживают смену программ.
+class RenderQueue {
+public:
+    DrawItem& submit(const DrawItem& item) {
+        items.push_back(item);
+        return items.back();
+    }
+
+    // Меши модели отдельными элементами; глубина - по центру AABB меша.
+    // instance - положение экземпляра, к нему добавляется model.meshTransforms
+    void submitModel(Model& model, Shader& shader, UniformHandle<glm::mat4> modelLoc,
+        UniformHandle<glm::mat3> normalLoc, const glm::mat4& instance, const glm::mat4& view, float farPlane,
+        RenderPass pass = RenderPass::Opaque, uint32_t material = 0) {
+        for (size_t i = 0; i < model.meshes.size(); i++) {
+            DrawItem item;
+            item.shader = &shader;
+            item.vertexArray = model.arena.VAO;
+            item.mesh = &model.meshes[i];
+            item.transform = instance * model.meshTransforms[i];
+            item.modelLoc = modelLoc;
+            item.normalLoc = normalLoc;
+            float depth = 0.0f;
+            if (i < model.meshBounds.size()) {
+                const AABB& box = model.meshBounds[i];
+                depth = RenderKey::viewDepth(view, glm::vec3(item.transform * glm::vec4(0.5f * (box.min + box.max), 1.0f)));
+            }
+            item.key = RenderKey::make(pass, shader.ID, material, item.vertexArray,
+                RenderKey::quantizeDepth(depth, farPlane));
+            items.push_back(item);
+        }
+    }
+
+    size_t size() const { return items.size(); }
+
+    // Элементы в порядке отправки
+    const std::vector<DrawItem>& submitted() const { return items; }
+
+    void clear() {
+        items.clear();
+    }
+
+    // Только сортировка, без рисования
+    void sort() {
+        const size_t n = items.size();
+        fillEntries();
+        scratch.resize(n);
+
+        // Гистограммы всех 8 байт за один проход
+        size_t counts[8][256];
+        std::memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) {
+            for (int b = 0; b < 8; b++)
+                counts[b][(entries[i].key >> (8 * b)) & 0xFF]++;
+        }
+        for (int b = 0; b < 8; b++) {
+            const uint64_t digit = n > 0 ? (entries[0].key >> (8 * b)) & 0xFF : 0;
+            if (counts[b][digit] == n)
+                continue;
+            size_t offset = 0;
+            for (int d = 0; d < 256; d++) {
+                size_t c = counts[b][d];
+                counts[b][d] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                const SortEntry& e = entries[i];
+                scratch[counts[b][(e.key >> (8 * b)) & 0xFF]++] = e;
+            }
+            entries.swap(scratch);
+        }
+    }
+
+    // Сортирует, исполняет и очищает очередь
+    void flush() {
+        sort();
+        execute();
+        clear();
+    }
+
+    // Исполняет в порядке отправки, без сортировки (для сравнения в --bench-queue)
+    void flushUnsorted() {
+        fillEntries();
+        execute();
+        clear();
+    }
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    void fillEntries() {
+        entries.resize(items.size());
+        for (size_t i = 0; i < items.size(); i++)
+            entries[i] = { items[i].key, (uint32_t)i };
+    }
+
+    // Программу и VAO каждый элемент ставит заново: draw-функции привязывают своё
+    // (PointCloud, IndirectRenderer), так что своя копия состояния здесь устарела бы.
+    // Повторы подряд отсекает кэш GLCalls, и сортировка делает их частыми
+    void execute() {
+        for (const SortEntry& e : entries) {
+            DrawItem& item = items[e.index];
+            if (item.shader != nullptr)
+                item.shader->use();
+            if (item.vertexArray != 0)
+                GLCalls::bindVertexArray(item.vertexArray);
+            if (item.draw != nullptr) {
+                item.draw(item);
+            }
+            else if (item.mesh != nullptr) {
+                item.shader->set(item.modelLoc, item.transform);
+                if (item.normalLoc.valid())
+                    item.shader->set(item.normalLoc, computeNormalMatrix(item.transform));
+                item.mesh->Draw(*item.shader);
+            }
+        }
+    }
+
+    std::vector<DrawItem> items;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+};
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,44 @@
+#ifndef RIGID_TRANSFORM_H
+#define RIGID_TRANSFORM_H
+
+#include <glm.hpp>
+#include <quaternion.hpp>
+
+// Жёсткое преобразование (поворот + перенос) без масштаба: x' = rotation * x + translation.
+// 7 чисел вместо 16; композиция - произведение кватернионов и один поворот вектора
+// вместо полного 4x4 произведения. В mat4 переводится только при заливке в GPU.
+struct RigidTransform {
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 translation = glm::vec3(0.0f);
+
+    RigidTransform() {}
+    RigidTransform(const glm::quat& rotation, const glm::vec3& translation)
+        : rotation(rotation), translation(translation) {}
+
+    // Поворот на rad вокруг оси axis (единичной), проходящей через point
+    static RigidTransform aroundPoint(float rad, const glm::vec3& point, const glm::vec3& axis) {
+        glm::quat q = glm::angleAxis(rad, axis);
+        return RigidTransform(q, point - q * point);
+    }
+
+    // (a * b)(x) = a(b(x))
+    RigidTransform operator*(const RigidTransform& b) const {
+        return RigidTransform(rotation * b.rotation, rotation * b.translation + translation);
+    }
+
+    RigidTransform inverse() const {
+        glm::quat inv = glm::conjugate(rotation);
+        return RigidTransform(inv, -(inv * translation));
+    }
+
+    glm::vec3 applyPoint(const glm::vec3& p) const { return rotation * p + translation; }
+    glm::vec3 applyVector(const glm::vec3& v) const { return rotation * v; }
+
+    glm::mat4 toMat4() const {
+        glm::mat4 m = glm::mat4_cast(rotation);
+        m[3] = glm::vec4(translation, 1.0f);
+        return m;
+    }
+};
+
+#endif // RIGID_TRANSFORM_H
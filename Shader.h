@@ -5,15 +5,42 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include <glm.hpp>
 #include <type_ptr.hpp>
 #include <GL/glew.h>
 
+#include "GLCalls.h"
+#include "Trace.h"
+
+template <typename T> struct UniformTypeOf;
+template <> struct UniformTypeOf<bool> { static const GLenum value = GL_BOOL; };
+template <> struct UniformTypeOf<int> { static const GLenum value = GL_INT; };
+template <> struct UniformTypeOf<float> { static const GLenum value = GL_FLOAT; };
+template <> struct UniformTypeOf<glm::vec3> { static const GLenum value = GL_FLOAT_VEC3; };
+template <> struct UniformTypeOf<glm::mat3> { static const GLenum value = GL_FLOAT_MAT3; };
+template <> struct UniformTypeOf<glm::mat4> { static const GLenum value = GL_FLOAT_MAT4; };
+
+// Заранее найденная location: установка через хэндл не трогает строки
+template <typename T>
+struct UniformHandle {
+    int location = -1;
+    bool valid() const { return location >= 0; }
+};
+
+struct UniformInfo {
+    std::string name;
+    GLenum type;
+    int location;
+};
+
 class Shader {
 public:
     unsigned int ID;
 
     Shader(const char* vertexPath, const char* fragmentPath) {
+        TRACE_SCOPE("Shader::Shader");
         std::string vertexCode = loadShaderFile(vertexPath);
         std::string fragmentCode = loadShaderFile(fragmentPath);
 
@@ -31,33 +58,128 @@ public:
 
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        reflectUniforms();
     }
 
     void use() {
-        glUseProgram(ID);
+        GLCalls::useProgram(ID);
+    }
+
+    // Сколько раз искали uniform по имени (setX по строке, uniform<T>()); сбрасывается каждый кадр
+    static unsigned int& uniformLookups() {
+        static unsigned int lookups = 0;
+        return lookups;
+    }
+
+    const std::vector<UniformInfo>& activeUniforms() const {
+        return uniforms;
+    }
+
+    template <typename T>
+    UniformHandle<T> uniform(const std::string& name) const {
+        UniformHandle<T> handle;
+        const UniformInfo* info = findUniform(name);
+        if (info == nullptr) {
+            std::cerr << "WARNING::SHADER::UNIFORM_NOT_ACTIVE: " << name << std::endl;
+            return handle;
+        }
+        if (info->type != UniformTypeOf<T>::value) {
+            std::cerr << "WARNING::SHADER::UNIFORM_TYPE_MISMATCH: " << name << std::endl;
+        }
+        handle.location = info->location;
+        return handle;
+    }
+
+    void set(UniformHandle<bool> handle, bool value) const {
+        GLCalls::uniform1i(handle.location, (int)value);
+    }
+
+    void set(UniformHandle<int> handle, int value) const {
+        GLCalls::uniform1i(handle.location, value);
+    }
+
+    void set(UniformHandle<float> handle, float value) const {
+        GLCalls::uniform1f(handle.location, value);
+    }
+
+    void set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const {
+        GLCalls::uniform3fv(handle.location, 1, &value[0]);
+    }
+
+    void set(UniformHandle<glm::mat3> handle, const glm::mat3& mat) const {
+        GLCalls::uniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+    }
+
+    void set(UniformHandle<glm::mat4> handle, const glm::mat4& mat) const {
+        GLCalls::uniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
 
     void setBool(const std::string& name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        GLCalls::uniform1i(location(name), (int)value);
     }
 
     void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        GLCalls::uniform1i(location(name), value);
     }
 
     void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        GLCalls::uniform1f(location(name), value);
     }
 
     void setVec3(const std::string& name, const glm::vec3& value) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        GLCalls::uniform3fv(location(name), 1, &value[0]);
     }
 
     void setMat4(const std::string& name, const glm::mat4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        GLCalls::uniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // Активные uniform-ы, отсортированные по имени (вместо glGetUniformLocation)
+    std::vector<UniformInfo> uniforms;
+
+    void reflectUniforms() {
+        GLint count = 0;
+        glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+        const GLenum props[] = { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_BLOCK_INDEX };
+        uniforms.clear();
+        uniforms.reserve(count);
+        for (GLint i = 0; i < count; i++) {
+            GLint values[4];
+            glGetProgramResourceiv(ID, GL_UNIFORM, i, 4, props, 4, NULL, values);
+            // uniform-блоки и их члены сюда не попадают
+            if (values[3] != -1 || values[2] < 0)
+                continue;
+
+            std::string name(values[0], '\0');
+            glGetProgramResourceName(ID, GL_UNIFORM, i, values[0], NULL, &name[0]);
+            name.resize(values[0] - 1);
+            // "arr[0]" доступен и как "arr"
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                name.resize(name.size() - 3);
+
+            uniforms.push_back({ name, (GLenum)values[1], values[2] });
+        }
+        std::sort(uniforms.begin(), uniforms.end(),
+            [](const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+    }
+
+    const UniformInfo* findUniform(const std::string& name) const {
+        ++uniformLookups();
+        auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+            [](const UniformInfo& u, const std::string& n) { return u.name < n; });
+        if (it == uniforms.end() || it->name != name)
+            return nullptr;
+        return &*it;
+    }
+
+    int location(const std::string& name) const {
+        const UniformInfo* info = findUniform(name);
+        return info ? info->location : -1;
+    }
+
     std::string loadShaderFile(const char* path) {
         std::ifstream file;
         file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -75,6 +197,7 @@ private:
     }
 
     unsigned int compileShader(unsigned int type, const char* code) {
+        TRACE_SCOPE("Shader::compileShader");
         unsigned int shader = glCreateShader(type);
         glShaderSource(shader, 1, &code, NULL);
         glCompileShader(shader);
@@ -0,0 +1,96 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <string>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Именованная разделяемая память между процессами: shm_open + mmap на POSIX,
+// именованное отображение страничного файла на Windows. Создатель обнуляет
+// область и на POSIX удаляет имя при уничтожении. На Windows отображение живёт,
+// пока открыто хоть одним процессом: создатель может получить уже существующее
+// (existed()) - его он не обнуляет, в нём могут читать.
+class SharedMemory {
+public:
+    SharedMemory(const std::string& name, size_t bytes, bool create) : length(bytes), owner(create) {
+#ifdef _WIN32
+        std::string objectName = "Local\\" + name;
+        if (create)
+            mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                (DWORD)((unsigned long long)bytes >> 32), (DWORD)bytes, objectName.c_str());
+        else
+            mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, objectName.c_str());
+        if (mapping == NULL)
+            return;
+        alreadyExisted = create && GetLastError() == ERROR_ALREADY_EXISTS;
+        ptr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+#else
+        objectName = "/" + name;
+        int fd = shm_open(objectName.c_str(), create ? O_CREAT | O_RDWR : O_RDWR, 0600);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (create ? ftruncate(fd, (off_t)bytes) != 0 : (fstat(fd, &st) != 0 || (size_t)st.st_size < bytes)) {
+            close(fd);
+            return;
+        }
+        void* p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+            return;
+        ptr = p;
+#endif
+        if (ptr != NULL && create && !alreadyExisted)
+            std::memset(ptr, 0, bytes);
+    }
+
+    ~SharedMemory() {
+#ifdef _WIN32
+        if (ptr != NULL)
+            UnmapViewOfFile(ptr);
+        if (mapping != NULL)
+            CloseHandle(mapping);
+#else
+        if (ptr != NULL)
+            munmap(ptr, length);
+        if (owner && ptr != NULL)
+            shm_unlink(objectName.c_str());
+#endif
+    }
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    bool valid() const { return ptr != NULL; }
+    void* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool existed() const { return alreadyExisted; }
+
+private:
+    void* ptr = NULL;
+    size_t length = 0;
+    bool owner = false;
+    bool alreadyExisted = false;
+#ifdef _WIN32
+    HANDLE mapping = NULL;
+#else
+    std::string objectName;
+#endif
+};
+
+#endif // SHARED_MEMORY_H
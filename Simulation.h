@@ -0,0 +1,153 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <glm.hpp>
+
+#include "Kinematics.h"
+#include "InverseKinematics.h"
+#include "TripleBuffer.h"
+#include "Trace.h"
+
+// Что оператор задаёт с клавиатуры; читается симуляцией на каждом шаге
+struct SimCommand {
+    float jointDirection[MAX_JOINTS] = {};  // -1, 0, +1 для каждого сустава
+    bool ikMode = false;
+    glm::vec3 ikTarget = glm::vec3(0.0f);
+};
+
+// Два последних шага симуляции: рендер интерполирует между ними
+struct SimSnapshot {
+    uint64_t tick = 0;
+    double time = 0.0;  // секунды от старта симуляции (по её часам) для state
+    JointState previousState;  // на time - dt
+    JointState state;
+};
+
+// Кинематика манипулятора в отдельном потоке с фиксированным шагом (по умолчанию 1 кГц).
+// Скорость суставов задана в градусах в секунду, поэтому не зависит от FPS;
+// при задержках потока пропущенные шаги догоняются с тем же dt, так что результат
+// определяется только последовательностью команд. Команды и снимки передаются
+// через тройные буферы, потоки друг друга не ждут. Рендер показывает состояние
+// на один шаг в прошлом, интерполируя между двумя последними снимками.
+class ArmSimulation {
+public:
+    float jointSpeed = 30.0f;  // градусов в секунду
+
+    explicit ArmSimulation(double rate = 1000.0) : dt(1.0 / rate) {}
+
+    ~ArmSimulation() {
+        stop();
+    }
+
+    ArmSimulation(const ArmSimulation&) = delete;
+    ArmSimulation& operator=(const ArmSimulation&) = delete;
+
+    // Дерево копируется: поток не видит последующих изменений (bind после Reload -
+    // через stop() и повторный start())
+    void start(const KinematicTree& kinematics, const JointState& initial) {
+        stop();
+        tree = kinematics;
+        state = initial;
+        tree.clamp(state);
+        SimSnapshot& first = snapshots.writeBuffer();
+        first.tick = 0;
+        first.time = 0.0;
+        first.previousState = state;
+        first.state = state;
+        snapshots.publish();
+        current = first;
+        epoch = std::chrono::steady_clock::now();
+        running = true;
+        worker = std::thread(&ArmSimulation::run, this);
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable())
+            worker.join();
+    }
+
+    // Поток рендера
+    void command(const SimCommand& cmd) {
+        commands.writeBuffer() = cmd;
+        commands.publish();
+    }
+
+    // Поток рендера: состояние на момент (сейчас - dt), линейно между двумя последними шагами
+    JointState interpolated() {
+        if (snapshots.update())
+            current = snapshots.read();
+        double displayTime = seconds() - dt;
+        float alpha = (float)glm::clamp((displayTime - (current.time - dt)) / dt, 0.0, 1.0);
+
+        JointState result;
+        for (size_t j = 0; j < tree.jointCount(); j++)
+            result.angles[j] = glm::mix(current.previousState.angles[j], current.state.angles[j], alpha);
+        return result;
+    }
+
+    uint64_t ticks() const { return current.tick; }
+    double stepSeconds() const { return dt; }
+
+private:
+    const double dt;
+    KinematicTree tree;
+    JointState state;          // принадлежит потоку симуляции
+    SimCommand lastCommand;    // тоже
+    TripleBuffer<SimCommand> commands;
+    TripleBuffer<SimSnapshot> snapshots;
+    SimSnapshot current;       // принадлежит читателю
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> running{ false };
+    std::thread worker;
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void step() {
+        TRACE_SCOPE("ArmSimulation::step");
+        if (commands.update())
+            lastCommand = commands.read();
+        if (lastCommand.ikMode) {
+            solveIK(tree, lastCommand.ikTarget, state);
+        }
+        else {
+            const float delta = jointSpeed * (float)dt;
+            for (size_t j = 0; j < tree.jointCount(); j++)
+                state.angles[j] += lastCommand.jointDirection[j] * delta;
+            tree.clamp(state);
+        }
+    }
+
+    void run() {
+        TRACE_THREAD("simulation");
+        // Не больше секунды догона: после долгой остановки (отладчик) время просто сдвигается
+        const uint64_t maxCatchUp = (uint64_t)(1.0 / dt);
+        uint64_t tick = 0;
+        while (running) {
+            uint64_t due = (uint64_t)(seconds() / dt);
+            if (due > tick + maxCatchUp)
+                tick = due - maxCatchUp;
+            while (tick < due) {
+                JointState before = state;
+                step();
+                tick++;
+                SimSnapshot& snapshot = snapshots.writeBuffer();
+                snapshot.tick = tick;
+                snapshot.time = tick * dt;
+                snapshot.previousState = before;
+                snapshot.state = state;
+                snapshots.publish();
+            }
+            std::this_thread::sleep_until(epoch + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((tick + 1) * dt)));
+        }
+    }
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,107 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+#include <GL/glew.h>
+#include "GpuMemory.h"
+#include "GLCalls.h"
+
+// Постоянно отображённый буфер из нескольких регионов для данных, которые
+// переписываются каждый кадр. Пока GPU читает регион кадра N, CPU пишет в
+// регион N+1; fence не даёт перезаписать регион, который ещё используется.
+class StreamBuffer {
+public:
+    unsigned int ID = 0;
+
+    explicit StreamBuffer(size_t regionBytes = 64 * 1024, unsigned int regionCount = 3)
+        : regionCount(regionCount) {
+        allocate(regionBytes);
+    }
+
+    ~StreamBuffer() {
+        destroy();
+    }
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Следующий регион под запись bytes байт (при нехватке буфер растёт)
+    void* map(size_t bytes) {
+        if (bytes > regionSize) {
+            destroy();
+            allocate(bytes + bytes / 2);
+        }
+        current = (current + 1) % regionCount;
+        waitFence(current);
+        currentBytes = bytes;
+        GLCalls::countUpload(bytes);
+        return mapped + current * regionSize;
+    }
+
+    size_t offset() const { return current * regionSize; }
+    size_t size() const { return currentBytes; }
+
+    void bindRange(GLenum target, unsigned int index) const {
+        GLCalls::bindBufferRange(target, index, ID, offset(), currentBytes > 0 ? currentBytes : 1);
+    }
+
+    // После команд, читающих текущий регион
+    void fence() {
+        if (fences[current] != 0)
+            glDeleteSync(fences[current]);
+        fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+private:
+    static const unsigned int MAX_REGIONS = 4;
+    // Не меньше GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT / GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    static const size_t REGION_ALIGNMENT = 256;
+
+    unsigned int regionCount;
+    size_t regionSize = 0;
+    unsigned int current = 0;
+    size_t currentBytes = 0;
+    char* mapped = nullptr;
+    GLsync fences[MAX_REGIONS] = {};
+
+    void allocate(size_t regionBytes) {
+        if (regionCount > MAX_REGIONS)
+            regionCount = MAX_REGIONS;
+        regionSize = (regionBytes + REGION_ALIGNMENT - 1) & ~(REGION_ALIGNMENT - 1);
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glCreateBuffers(1, &ID);
+        glNamedBufferStorage(ID, regionSize * regionCount, NULL, flags);
+        mapped = static_cast<char*>(glMapNamedBufferRange(ID, 0, regionSize * regionCount, flags));
+        trackBufferCreated(regionSize * regionCount);
+    }
+
+    void destroy() {
+        if (ID == 0)
+            return;
+        for (unsigned int i = 0; i < MAX_REGIONS; i++) {
+            if (fences[i] != 0) {
+                glDeleteSync(fences[i]);
+                fences[i] = 0;
+            }
+        }
+        glUnmapNamedBuffer(ID);
+        GLCalls::deleteBuffer(ID);
+        trackBufferDeleted(regionSize * regionCount);
+        ID = 0;
+        mapped = nullptr;
+    }
+
+    void waitFence(unsigned int region) {
+        GLsync sync = fences[region];
+        if (sync == 0)
+            return;
+        GLenum status = glClientWaitSync(sync, 0, 0);
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        glDeleteSync(sync);
+        fences[region] = 0;
+    }
+};
+
+#endif // STREAM_BUFFER_H
@@ -0,0 +1,252 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Запись временной шкалы в формате Chrome Trace Event (chrome://tracing, ui.perfetto.dev).
+// Вся запись - макросы; без LAB7_TRACE (свойства проекта -> C/C++ -> Препроцессор)
+// они пусты, и в сборке не остаётся ни кода, ни данных трассировки.
+//   TRACE_SCOPE("имя")   - событие от этой строки до конца блока; имя - строковый литерал
+//   TRACE_THREAD("имя")  - подпись дорожки текущего потока
+// Каждый поток пишет в свой буфер из блоков по CHUNK_EVENTS событий без блокировок:
+// писатель один, число событий публикуется атомарно, блоки не перемещаются, так что
+// Trace::write можно вызвать и при работающих потоках. Мьютекс берётся только при
+// первой записи потока (регистрация буфера) и при выгрузке.
+
+#ifdef LAB7_TRACE
+
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace Trace {
+    struct Event {
+        const char* name;
+        int64_t startNs;
+        int64_t durationNs;
+    };
+
+    const size_t CHUNK_EVENTS = 4096;
+    const size_t MAX_CHUNKS = 4096;  // 16M событий на поток, дальше - отбрасываются
+
+    inline int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    class ThreadBuffer {
+    public:
+        uint32_t tid;
+        std::string name;  // под мьютексом реестра
+
+        explicit ThreadBuffer(uint32_t tid) : tid(tid) {
+            for (size_t i = 0; i < MAX_CHUNKS; i++)
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~ThreadBuffer() {
+            for (size_t i = 0; i < MAX_CHUNKS; i++)
+                delete chunks[i].load(std::memory_order_relaxed);
+        }
+
+        ThreadBuffer(const ThreadBuffer&) = delete;
+        ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+        // Только поток-владелец
+        void push(const Event& event) {
+            size_t n = count.load(std::memory_order_relaxed);
+            size_t c = n / CHUNK_EVENTS;
+            if (c >= MAX_CHUNKS) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Chunk* chunk = chunks[c].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                chunk = new Chunk;
+                chunks[c].store(chunk, std::memory_order_release);
+            }
+            chunk->events[n % CHUNK_EVENTS] = event;
+            count.store(n + 1, std::memory_order_release);
+        }
+
+        // Любой поток: события, опубликованные к моменту вызова
+        template <typename F>
+        void forEach(F&& f) const {
+            size_t n = count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; i++)
+                f(chunks[i / CHUNK_EVENTS].load(std::memory_order_acquire)->events[i % CHUNK_EVENTS]);
+        }
+
+        uint64_t droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Chunk {
+            Event events[CHUNK_EVENTS];
+        };
+
+        std::atomic<Chunk*> chunks[MAX_CHUNKS];
+        std::atomic<size_t> count{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+    };
+
+    // Буферы живут до конца программы: события завершившихся потоков не теряются
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::deque<std::string> names;  // строки для intern, адреса не меняются
+        std::atomic<bool> enabled{ false };
+        int64_t epochNs = 0;
+    };
+
+    inline Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    inline bool enabled() {
+        return registry().enabled.load(std::memory_order_relaxed);
+    }
+
+    inline ThreadBuffer* addBuffer(const std::string& name) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.emplace_back(new ThreadBuffer((uint32_t)r.buffers.size() + 1));
+        r.buffers.back()->name = name;
+        return r.buffers.back().get();
+    }
+
+    inline ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr)
+            buffer = addBuffer("thread");
+        return *buffer;
+    }
+
+    inline void setThreadName(const char* name) {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        buffer.name = name;
+    }
+
+    // Постоянная копия имени (для имён, собранных во время работы)
+    inline const char* intern(const std::string& name) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const std::string& s : r.names) {
+            if (s == name)
+                return s.c_str();
+        }
+        r.names.push_back(name);
+        return r.names.back().c_str();
+    }
+
+    // Отдельная дорожка для интервалов, измеренных не на CPU (например, GL_TIMESTAMP);
+    // писатель у дорожки тоже должен быть один
+    inline ThreadBuffer& track(const char* name) {
+        Registry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (auto& buffer : r.buffers) {
+                if (buffer->name == name)
+                    return *buffer;
+            }
+        }
+        return *addBuffer(name);
+    }
+
+    inline void start() {
+        registry().epochNs = nowNs();
+        registry().enabled.store(true, std::memory_order_relaxed);
+    }
+
+    inline void stop() {
+        registry().enabled.store(false, std::memory_order_relaxed);
+    }
+
+    inline void writeJsonString(std::ostream& out, const char* s) {
+        out << '"';
+        for (; *s; s++) {
+            if (*s == '"' || *s == '\\')
+                out << '\\';
+            if ((unsigned char)*s >= 0x20)
+                out << *s;
+        }
+        out << '"';
+    }
+
+    inline bool write(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "ERROR::TRACE::FILE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Lab_7\"}}";
+        size_t events = 0;
+        uint64_t dropped = 0;
+        char number[64];
+        for (const auto& buffer : r.buffers) {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+            writeJsonString(out, buffer->name.c_str());
+            out << "}}";
+            buffer->forEach([&](const Event& e) {
+                // Микросекунды с точностью до наносекунды
+                snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f", (e.startNs - r.epochNs) * 1e-3, e.durationNs * 1e-3);
+                out << ",\n{\"name\":";
+                writeJsonString(out, e.name);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":" << number << "}";
+                events++;
+            });
+            dropped += buffer->droppedEvents();
+        }
+        out << "\n]}\n";
+        std::cout << "trace: " << events << " events on " << r.buffers.size() << " tracks -> " << path;
+        if (dropped > 0)
+            std::cout << " (" << dropped << " dropped)";
+        std::cout << std::endl;
+        return (bool)out;
+    }
+
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name(name), active(enabled()) {
+            if (active)
+                start = nowNs();
+        }
+
+        ~Scope() {
+            if (active)
+                threadBuffer().push({ name, start, nowNs() - start });
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        bool active;
+        int64_t start = 0;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD(name) Trace::setThreadName(name)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+
+#endif // LAB7_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,362 @@
+#ifndef TRAJECTORY_LOG_H
+#define TRAJECTORY_LOG_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <glm.hpp>
+
+#include "Kinematics.h"
+#include "MappedFile.h"
+
+// Журнал траектории: метки времени (мкс) и углы суставов (целые тысячные градуса).
+//   заголовок  "TRJL", версия, число суставов, интервал ключевых кадров
+//   записи     'K' время int64, углы int32[n]                  - каждая interval-я
+//              'D' varint(dt), varint(zigzag(dугла))[n]        - остальные
+//   индекс     (время, смещение, номер) каждого ключевого кадра
+//   хвост      смещение индекса, число ключевых кадров и записей, "TRJI"
+// Углы квантуются до записи, так что дельты восстанавливаются без накопления
+// ошибки. Покой стоит 1 + 1 + n байт на запись. Переход к моменту - двоичный
+// поиск по индексу и не больше interval записей вперёд. Если запись оборвалась
+// (нет хвоста), индекс восстанавливается проходом по записям.
+namespace TrajectoryFormat {
+    const char MAGIC[4] = { 'T', 'R', 'J', 'L' };
+    const char INDEX_MAGIC[4] = { 'T', 'R', 'J', 'I' };
+    const uint32_t VERSION = 1;
+    const float ANGLE_SCALE = 1000.0f;  // единиц на градус
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t jointCount;
+        uint32_t keyframeInterval;
+    };
+
+    struct KeyframeEntry {
+        int64_t timeUs;
+        uint64_t offset;
+        uint64_t sample;
+    };
+
+    struct Trailer {
+        uint64_t indexOffset;
+        uint64_t keyframeCount;
+        uint64_t sampleCount;
+        char magic[4];
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+    static_assert(sizeof(KeyframeEntry) == 24, "KeyframeEntry layout");
+    static_assert(sizeof(Trailer) == 32, "Trailer layout");
+
+    inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+    inline int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+    inline int32_t quantize(float degrees) { return (int32_t)std::lround(degrees * ANGLE_SCALE); }
+}
+
+struct TrajectorySample {
+    int64_t timeUs = 0;
+    JointState state;
+};
+
+class TrajectoryWriter {
+public:
+    TrajectoryWriter(const std::string& path, uint32_t jointCount, uint32_t keyframeInterval = 256)
+        : file(path, std::ios::binary | std::ios::trunc), jointCount(std::min<uint32_t>(jointCount, MAX_JOINTS)),
+        keyframeInterval(std::max<uint32_t>(keyframeInterval, 1)) {
+        if (!file)
+            return;
+        TrajectoryFormat::FileHeader header;
+        std::memcpy(header.magic, TrajectoryFormat::MAGIC, 4);
+        header.version = TrajectoryFormat::VERSION;
+        header.jointCount = this->jointCount;
+        header.keyframeInterval = this->keyframeInterval;
+        put(&header, sizeof(header));
+    }
+
+    ~TrajectoryWriter() {
+        close();
+    }
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool valid() const { return file.is_open() && file.good(); }
+    uint64_t samples() const { return sampleCount; }
+    uint64_t bytes() const { return offset; }
+
+    // Время не должно убывать (меньшее приравнивается к предыдущему)
+    void append(int64_t timeUs, const JointState& state) {
+        if (!file.is_open())
+            return;
+        timeUs = std::max(timeUs, previousTime);
+        int32_t q[MAX_JOINTS];
+        for (uint32_t j = 0; j < jointCount; j++)
+            q[j] = TrajectoryFormat::quantize(state.angles[j]);
+
+        if (sampleCount % keyframeInterval == 0) {
+            index.push_back({ timeUs, offset, sampleCount });
+            putByte('K');
+            put(&timeUs, sizeof(timeUs));
+            put(q, jointCount * sizeof(int32_t));
+        }
+        else {
+            putByte('D');
+            putVarint((uint64_t)(timeUs - previousTime));
+            for (uint32_t j = 0; j < jointCount; j++)
+                putVarint(TrajectoryFormat::zigzag((int64_t)q[j] - previous[j]));
+        }
+        previousTime = timeUs;
+        std::memcpy(previous, q, sizeof(q));
+        sampleCount++;
+        if (buffer.size() >= 64 * 1024)
+            flush();
+    }
+
+    // Дописывает индекс и хвост; после этого запись невозможна
+    void close() {
+        if (!file.is_open())
+            return;
+        TrajectoryFormat::Trailer trailer = {};
+        trailer.indexOffset = offset;
+        trailer.keyframeCount = index.size();
+        trailer.sampleCount = sampleCount;
+        std::memcpy(trailer.magic, TrajectoryFormat::INDEX_MAGIC, 4);
+        if (!index.empty())
+            put(index.data(), index.size() * sizeof(TrajectoryFormat::KeyframeEntry));
+        put(&trailer, sizeof(trailer));
+        flush();
+        file.close();
+    }
+
+private:
+    std::ofstream file;
+    uint32_t jointCount;
+    uint32_t keyframeInterval;
+    std::vector<unsigned char> buffer;
+    std::vector<TrajectoryFormat::KeyframeEntry> index;
+    uint64_t offset = 0;
+    uint64_t sampleCount = 0;
+    int64_t previousTime = 0;
+    int32_t previous[MAX_JOINTS] = {};
+
+    void put(const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        buffer.insert(buffer.end(), p, p + size);
+        offset += size;
+    }
+
+    void putByte(unsigned char b) {
+        buffer.push_back(b);
+        offset++;
+    }
+
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            putByte((unsigned char)(v | 0x80));
+            v >>= 7;
+        }
+        putByte((unsigned char)v);
+    }
+
+    void flush() {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
+    }
+};
+
+// Чтение через отображение файла в память: последовательно (next), переходом
+// к моменту (seek) и с интерполяцией для воспроизведения с любой скоростью (sampleAt)
+class TrajectoryReader {
+public:
+    explicit TrajectoryReader(const std::string& path) : file(path) {
+        if (!file.valid() || file.size() < sizeof(TrajectoryFormat::FileHeader))
+            return;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, TrajectoryFormat::MAGIC, 4) != 0 ||
+            header.version != TrajectoryFormat::VERSION || header.jointCount > MAX_JOINTS)
+            return;
+        if (!readIndex())
+            rebuildIndex();
+        ok = !index.empty();
+        if (ok) {
+            startTime = index.front().timeUs;
+            seek(startTime);
+        }
+    }
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    bool valid() const { return ok; }
+    uint32_t jointCount() const { return header.jointCount; }
+    uint64_t sampleCount() const { return samples; }
+    int64_t startUs() const { return startTime; }
+    int64_t endUs() const { return endTime; }
+
+    // Следующая запись; false в конце журнала
+    bool next(TrajectorySample& out) {
+        if (!decode())
+            return false;
+        out.timeUs = cursorTime;
+        for (uint32_t j = 0; j < header.jointCount; j++)
+            out.state.angles[j] = cursorAngles[j] / TrajectoryFormat::ANGLE_SCALE;
+        return true;
+    }
+
+    // Курсор на последний ключевой кадр не позже timeUs: следующий next() вернёт его
+    void seek(int64_t timeUs) {
+        cursor = file.data() + keyframeAt(timeUs).offset;
+        havePair = false;
+    }
+
+    // Поза на момент timeUs, линейно между соседними записями. Вперёд по времени
+    // в пределах текущего ключевого кадра (обычное воспроизведение) записи просто
+    // читаются подряд, иначе - seek
+    bool sampleAt(int64_t timeUs, JointState& state) {
+        if (!ok)
+            return false;
+        timeUs = glm::clamp(timeUs, startTime, endTime);
+        if (!havePair || timeUs < before.timeUs || keyframeAt(timeUs).timeUs > after.timeUs) {
+            seek(timeUs);
+            if (!next(before))
+                return false;
+            after = before;
+            havePair = true;
+        }
+        while (after.timeUs <= timeUs) {
+            TrajectorySample sample;
+            if (!next(sample))
+                break;
+            before = after;
+            after = sample;
+        }
+        if (after.timeUs <= timeUs || after.timeUs == before.timeUs) {
+            state = after.timeUs <= timeUs ? after.state : before.state;
+            return true;
+        }
+        float alpha = (float)(timeUs - before.timeUs) / (float)(after.timeUs - before.timeUs);
+        for (uint32_t j = 0; j < header.jointCount; j++)
+            state.angles[j] = glm::mix(before.state.angles[j], after.state.angles[j], alpha);
+        return true;
+    }
+
+private:
+    MappedFile file;
+    TrajectoryFormat::FileHeader header = {};
+    std::vector<TrajectoryFormat::KeyframeEntry> index;
+    const unsigned char* recordsEnd = nullptr;
+    uint64_t samples = 0;
+    int64_t startTime = 0;
+    int64_t endTime = 0;
+    bool ok = false;
+
+    const unsigned char* cursor = nullptr;
+    int64_t cursorTime = 0;
+    int32_t cursorAngles[MAX_JOINTS] = {};
+
+    TrajectorySample before, after;
+    bool havePair = false;
+
+    const TrajectoryFormat::KeyframeEntry& keyframeAt(int64_t timeUs) const {
+        auto it = std::upper_bound(index.begin(), index.end(), timeUs,
+            [](int64_t t, const TrajectoryFormat::KeyframeEntry& e) { return t < e.timeUs; });
+        return it == index.begin() ? *it : *(it - 1);
+    }
+
+    bool getVarint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && cursor < recordsEnd; shift += 7) {
+            unsigned char b = *cursor++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Одна запись из cursor в cursorTime/cursorAngles
+    bool decode() {
+        if (cursor == nullptr || cursor >= recordsEnd)
+            return false;
+        unsigned char tag = *cursor++;
+        const size_t n = header.jointCount;
+        if (tag == 'K') {
+            if ((size_t)(recordsEnd - cursor) < sizeof(int64_t) + n * sizeof(int32_t)) {
+                cursor = recordsEnd;
+                return false;
+            }
+            std::memcpy(&cursorTime, cursor, sizeof(int64_t));
+            std::memcpy(cursorAngles, cursor + sizeof(int64_t), n * sizeof(int32_t));
+            cursor += sizeof(int64_t) + n * sizeof(int32_t);
+            return true;
+        }
+        uint64_t dt;
+        int32_t angles[MAX_JOINTS];
+        bool good = tag == 'D' && getVarint(dt);
+        for (size_t j = 0; good && j < n; j++) {
+            uint64_t d;
+            good = getVarint(d);
+            angles[j] = (int32_t)(cursorAngles[j] + TrajectoryFormat::unzigzag(d));
+        }
+        if (!good) {
+            // Оборванная или повреждённая запись: дальше читать нечего
+            cursor = recordsEnd;
+            return false;
+        }
+        cursorTime += (int64_t)dt;
+        std::memcpy(cursorAngles, angles, n * sizeof(int32_t));
+        return true;
+    }
+
+    bool readIndex() {
+        const size_t size = file.size();
+        if (size < sizeof(TrajectoryFormat::FileHeader) + sizeof(TrajectoryFormat::Trailer))
+            return false;
+        TrajectoryFormat::Trailer trailer;
+        std::memcpy(&trailer, file.data() + size - sizeof(trailer), sizeof(trailer));
+        if (std::memcmp(trailer.magic, TrajectoryFormat::INDEX_MAGIC, 4) != 0 ||
+            trailer.indexOffset < sizeof(TrajectoryFormat::FileHeader) ||
+            trailer.indexOffset + trailer.keyframeCount * sizeof(TrajectoryFormat::KeyframeEntry) + sizeof(trailer) != size)
+            return false;
+        index.resize((size_t)trailer.keyframeCount);
+        if (!index.empty())
+            std::memcpy(index.data(), file.data() + trailer.indexOffset, index.size() * sizeof(TrajectoryFormat::KeyframeEntry));
+        recordsEnd = file.data() + trailer.indexOffset;
+        samples = trailer.sampleCount;
+        if (index.empty())
+            return true;
+
+        // Время конца - по записям после последнего ключевого кадра
+        cursor = file.data() + index.back().offset;
+        while (decode())
+            endTime = cursorTime;
+        return true;
+    }
+
+    void rebuildIndex() {
+        index.clear();
+        recordsEnd = file.data() + file.size();
+        cursor = file.data() + sizeof(TrajectoryFormat::FileHeader);
+        samples = 0;
+        for (;;) {
+            uint64_t offset = (uint64_t)(cursor - file.data());
+            bool keyframe = cursor < recordsEnd && *cursor == 'K';
+            if (!decode())
+                break;
+            if (keyframe)
+                index.push_back({ cursorTime, offset, samples });
+            endTime = cursorTime;
+            samples++;
+        }
+        recordsEnd = cursor;
+    }
+};
+
+#endif // TRAJECTORY_LOG_H
@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Тройной буфер без блокировок для одного писателя и одного читателя.
+// Писатель заполняет свой буфер и публикует его обменом с "средним";
+// читатель забирает средний буфер, только если с прошлого раза был новый.
+// Ни одна сторона не ждёт другую; читатель всегда видит последнее целое значение.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Писатель: буфер под запись, затем publish()
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        unsigned int previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX;
+    }
+
+    // Читатель: true, если опубликовано новое значение (оно становится read())
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        unsigned int previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX;
+        return true;
+    }
+
+    const T& read() const { return buffers[front]; }
+
+private:
+    static const unsigned int INDEX = 3;
+    static const unsigned int FRESH = 4;
+
+    T buffers[3];
+    std::atomic<unsigned int> middle;  // индекс среднего буфера | FRESH
+    unsigned int back = 0;             // принадлежит писателю
+    unsigned int front = 2;            // принадлежит читателю
+};
+
+#endif // TRIPLE_BUFFER_H
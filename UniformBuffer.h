@@ -0,0 +1,85 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <cstring>
+#include <glm.hpp>
+#include <GL/glew.h>
+#include "GpuMemory.h"
+#include "GLCalls.h"
+
+// Фиксированные точки привязки, общие для всех шейдерных программ
+// (должны совпадать с layout(binding = N) в GLSL)
+enum UniformBinding : unsigned int {
+    CAMERA_BLOCK_BINDING = 0,
+    LIGHT_BLOCK_BINDING = 1,
+    MATERIAL_BLOCK_BINDING = 2
+};
+
+// Раскладка std140: vec3 выравнивается на 16 байт, поэтому явные pad-поля
+struct CameraBlock {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 viewPos;
+    float pad0;
+};
+
+struct LightBlock {
+    glm::vec3 position;
+    float pad0;
+    glm::vec3 ambient;
+    float pad1;
+    glm::vec3 diffuse;
+    float pad2;
+    glm::vec3 specular;
+    float pad3;
+};
+
+struct MaterialBlock {
+    glm::vec3 ambient;
+    float pad0;
+    glm::vec3 diffuse;
+    float pad1;
+    glm::vec3 specular;
+    float shininess;
+};
+
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock must match std140 layout");
+static_assert(sizeof(LightBlock) == 64, "LightBlock must match std140 layout");
+static_assert(sizeof(MaterialBlock) == 48, "MaterialBlock must match std140 layout");
+
+template <typename T>
+class UniformBuffer {
+public:
+    unsigned int ID = 0;
+    unsigned int binding;
+
+    explicit UniformBuffer(unsigned int binding) : binding(binding) {
+        glCreateBuffers(1, &ID);
+        glNamedBufferStorage(ID, sizeof(T), NULL, GL_DYNAMIC_STORAGE_BIT);
+        trackBufferCreated(sizeof(T));
+        GLCalls::bindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+    }
+
+    ~UniformBuffer() {
+        GLCalls::deleteBuffer(ID);
+        trackBufferDeleted(sizeof(T));
+    }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // Весь блок одним вызовом; неизменившийся блок повторно не заливается
+    void update(const T& data) {
+        if (uploaded && std::memcmp(&last, &data, sizeof(T)) == 0)
+            return;
+        GLCalls::namedBufferSubData(ID, 0, sizeof(T), &data);
+        last = data;
+        uploaded = true;
+    }
+
+private:
+    T last;
+    bool uploaded = false;
+};
+
+#endif // UNIFORM_BUFFER_H
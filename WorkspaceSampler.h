@@ -0,0 +1,222 @@
+#ifndef WORKSPACE_SAMPLER_H
+#define WORKSPACE_SAMPLER_H
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <glm.hpp>
+
+#include "Kinematics.h"
+#include "BatchFK.h"
+#include "Trace.h"
+
+// Разреженная воксельная сетка: открытая адресация с линейным пробированием,
+// ключ - три 21-битные координаты ячейки в одном uint64.
+// Подряд идущие точки развёртки обычно попадают в ту же ячейку - для них
+// запоминается последний найденный слот.
+class VoxelGrid {
+public:
+    explicit VoxelGrid(size_t capacity = 4096) {
+        size_t c = 16;
+        while (c < capacity)
+            c <<= 1;
+        keys.assign(c, uint64_t(EMPTY));
+        hits.assign(c, 0);
+        used = 0;
+    }
+
+    void add(const glm::ivec3& cell, uint32_t count = 1) {
+        uint64_t key = pack(cell);
+        if (key == lastKey) {
+            hits[lastSlot] += count;
+            return;
+        }
+        if ((used + 1) * 2 > keys.size())
+            grow();
+        size_t slot = find(key);
+        if (keys[slot] == EMPTY) {
+            keys[slot] = key;
+            used++;
+        }
+        hits[slot] += count;
+        lastKey = key;
+        lastSlot = slot;
+    }
+
+    void merge(const VoxelGrid& other) {
+        for (size_t i = 0; i < other.keys.size(); i++) {
+            if (other.keys[i] != EMPTY)
+                add(unpack(other.keys[i]), other.hits[i]);
+        }
+    }
+
+    size_t size() const { return used; }
+
+    // fn(const glm::ivec3& cell, uint32_t hits)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] != EMPTY)
+                fn(unpack(keys[i]), hits[i]);
+        }
+    }
+
+private:
+    static const uint64_t EMPTY = ~0ull;
+    static const int BIAS = 1 << 20;  // ячейки от -2^20 до 2^20-1 по каждой оси
+
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> hits;
+    size_t used = 0;
+    uint64_t lastKey = EMPTY;
+    size_t lastSlot = 0;
+
+    static uint64_t pack(const glm::ivec3& c) {
+        return (uint64_t)(c.x + BIAS) | ((uint64_t)(c.y + BIAS) << 21) | ((uint64_t)(c.z + BIAS) << 42);
+    }
+
+    static glm::ivec3 unpack(uint64_t key) {
+        const uint64_t mask = (1ull << 21) - 1;
+        return glm::ivec3((int)(key & mask) - BIAS, (int)((key >> 21) & mask) - BIAS, (int)((key >> 42) & mask) - BIAS);
+    }
+
+    size_t find(uint64_t key) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        while (keys[slot] != EMPTY && keys[slot] != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void grow() {
+        std::vector<uint64_t> oldKeys;
+        std::vector<uint32_t> oldHits;
+        oldKeys.swap(keys);
+        oldHits.swap(hits);
+        keys.assign(oldKeys.size() * 2, uint64_t(EMPTY));
+        hits.assign(oldKeys.size() * 2, 0);
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldKeys[i] == EMPTY)
+                continue;
+            size_t slot = find(oldKeys[i]);
+            keys[slot] = oldKeys[i];
+            hits[slot] = oldHits[i];
+        }
+        lastKey = EMPTY;
+    }
+};
+
+// Достижимый объём: занятые ячейки и сколько выборок в каждую попало
+struct WorkspaceMap {
+    float voxelSize = 0.0f;
+    std::vector<glm::vec3> centers;
+    std::vector<uint32_t> hits;
+    uint32_t maxHits = 0;
+    uint64_t samples = 0;
+    unsigned int threads = 0;
+    double seconds = 0.0;
+};
+
+// Равномерная развёртка пространства суставов в пределах joint.minAngle..maxAngle:
+// по каждому суставу одинаковое число шагов, всего не меньше samples конфигураций.
+// Развёртка режется на куски, потоки берут их через атомарный счётчик и копят
+// рабочие точки (evaluateFK) в своих сетках; в конце сетки сливаются.
+// threads = 0 - по числу ядер.
+inline WorkspaceMap sampleWorkspace(const KinematicTree& tree, uint64_t samples, float voxelSize, unsigned int threads = 0) {
+    WorkspaceMap map;
+    map.voxelSize = voxelSize;
+    const size_t jointCount = tree.jointCount();
+    if (jointCount == 0 || samples == 0 || voxelSize <= 0.0f)
+        return map;
+
+    uint64_t steps = std::max<uint64_t>(2, (uint64_t)std::ceil(std::pow((double)samples, 1.0 / jointCount) - 1e-9));
+    uint64_t total = 1;
+    for (size_t j = 0; j < jointCount; j++)
+        total *= steps;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    map.samples = total;
+    map.threads = threads;
+
+    const uint64_t CHUNK = 1 << 16;
+    const size_t BATCH = 1024;
+    std::atomic<uint64_t> nextChunk(0);
+    std::vector<VoxelGrid> grids(threads);
+    const float inverseVoxel = 1.0f / voxelSize;
+
+    auto worker = [&](unsigned int t) {
+        if (t > 0)
+            TRACE_THREAD("workspace");
+        // Своя сетка на стеке потока: соседние элементы grids делили бы кэш-линии
+        VoxelGrid grid;
+        std::vector<JointState> states(BATCH);
+        std::vector<Pose> poses(BATCH);
+        float angleStep[MAX_JOINTS];
+        for (size_t j = 0; j < jointCount; j++)
+            angleStep[j] = (tree.joints[j].maxAngle - tree.joints[j].minAngle) / (float)(steps - 1);
+
+        for (;;) {
+            uint64_t begin = nextChunk.fetch_add(CHUNK);
+            if (begin >= total)
+                break;
+            uint64_t end = std::min(total, begin + CHUNK);
+            TRACE_SCOPE("sampleWorkspace chunk");
+
+            // Индекс конфигурации в смешанной системе счисления: младший разряд - последний сустав
+            uint64_t digit[MAX_JOINTS];
+            uint64_t rest = begin;
+            for (size_t j = jointCount; j-- > 0;) {
+                digit[j] = rest % steps;
+                rest /= steps;
+            }
+
+            for (uint64_t i = begin; i < end; i += BATCH) {
+                size_t n = (size_t)std::min<uint64_t>(BATCH, end - i);
+                for (size_t k = 0; k < n; k++) {
+                    for (size_t j = 0; j < jointCount; j++)
+                        states[k].angles[j] = tree.joints[j].minAngle + angleStep[j] * digit[j];
+                    for (size_t j = jointCount; j-- > 0;) {
+                        if (++digit[j] < steps)
+                            break;
+                        digit[j] = 0;
+                    }
+                }
+                evaluateFK(tree, states.data(), n, poses.data());
+                for (size_t k = 0; k < n; k++) {
+                    glm::vec3 cell = glm::floor(poses[k].position * inverseVoxel);
+                    grid.add(glm::ivec3(cell));
+                }
+            }
+        }
+        grids[t] = std::move(grid);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; t++)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& thread : pool)
+        thread.join();
+
+    VoxelGrid& merged = grids[0];
+    for (unsigned int t = 1; t < threads; t++)
+        merged.merge(grids[t]);
+    map.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    map.centers.reserve(merged.size());
+    map.hits.reserve(merged.size());
+    merged.forEach([&](const glm::ivec3& cell, uint32_t hits) {
+        map.centers.push_back((glm::vec3(cell) + 0.5f) * voxelSize);
+        map.hits.push_back(hits);
+        map.maxHits = std::max(map.maxHits, hits);
+    });
+    return map;
+}
+
+#endif // WORKSPACE_SAMPLER_H
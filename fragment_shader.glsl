@@ -4,24 +4,25 @@ out vec4 FragColor;
 in vec3 Normal;
 in vec3 FragPos;
 
-uniform vec3 viewPos;
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
 
-struct Material {
+layout(std140, binding = 1) uniform LightBlock {
+    vec3 position;
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-    float shininess;
-}; 
+} light;
 
-struct Light {
-    vec3 position;
+layout(std140, binding = 2) uniform MaterialBlock {
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-};
-
-uniform Material material;
-uniform Light light;
+    float shininess;
+} material;
 
 void main() {
     // Ambient
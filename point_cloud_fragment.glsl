@@ -0,0 +1,10 @@
+#version 460 core
+out vec4 FragColor;
+
+in float Weight;
+
+void main() {
+    // Редко достижимые ячейки - синие, часто - жёлтые
+    vec3 color = mix(vec3(0.1, 0.3, 1.0), vec3(1.0, 0.9, 0.2), Weight);
+    FragColor = vec4(color, 1.0);
+}
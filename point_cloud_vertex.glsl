@@ -0,0 +1,21 @@
+#version 460 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in float aWeight;
+
+out float Weight;
+
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+uniform float pointSize;
+
+void main() {
+    Weight = aWeight;
+    vec4 viewPosition = view * vec4(aPos, 1.0);
+    gl_Position = projection * viewPosition;
+    // Ближние точки крупнее, чтобы облако читалось как объём
+    gl_PointSize = clamp(pointSize / max(-viewPosition.z, 0.1), 1.0, 16.0);
+}
@@ -0,0 +1,29 @@
+#version 460 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+
+out vec3 FragPos;
+out vec3 Normal;
+
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+struct PartTransform {
+    mat4 model;
+    mat3 normalMatrix;
+};
+
+// Часть p экземпляра i лежит в parts[p * instanceCount + i]; baseInstance = p * instanceCount
+layout(std430, binding = 0) readonly buffer PartTransforms {
+    PartTransform parts[];
+};
+
+void main() {
+    PartTransform part = parts[gl_BaseInstance + gl_InstanceID];
+    FragPos = vec3(part.model * vec4(aPos, 1.0));
+    Normal = part.normalMatrix * aNormal;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
@@ -5,12 +5,17 @@ layout(location = 1) in vec3 aNormal;
 out vec3 FragPos;
 out vec3 Normal;
 
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
     gl_Position = projection * view * vec4(FragPos, 1.0); 
 }
\ No newline at end of file